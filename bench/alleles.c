@@ -0,0 +1,169 @@
+#define _POSIX_C_SOURCE 200809L
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+#include "../include/hgvs.h"
+
+
+// Parses alleles of 10, 1k and 100k variants (or of the given numbers
+// of variants) and reports per variant: the time to parse, the size of
+// the frozen tree, the time to visit every variant of the allele with
+// HGVS_node_item() and the time to write the canonical form. Every
+// allele is parsed until a million variants are done. Usage:
+//     bench/alleles [variants ...]
+static size_t const VARIANTS[] = {10, 1000, 100000};
+static size_t const TOTAL      = 1000000;
+
+
+// keeps the visits from being optimized away
+static volatile size_t sink = 0;
+
+
+static double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+} // now
+
+
+// one of a few common shapes, compound inserts included
+static int
+describe(char* const buf, size_t const size, size_t const i)
+{
+    size_t const pos = 100 + 10 * i;
+    switch (i % 4)
+    {
+        case 0:
+            return snprintf(buf, size, "%zuA>C", pos);
+        case 1:
+            return snprintf(buf, size, "%zu_%zudel", pos, pos + 2);
+        case 2:
+            return snprintf(buf, size, "%zu_%zuins[ACG;%zu_%zu;T]", pos, pos + 1, pos + 5, pos + 7);
+        default:
+            return snprintf(buf, size, "%zudup", pos);
+    } // switch
+} // describe
+
+
+static char*
+allele(size_t const variants)
+{
+    size_t const size = 32 + variants * 40;
+    char* const str = malloc(size);
+    if (str == NULL)
+    {
+        return NULL;
+    } // if
+    size_t len = snprintf(str, size, "NC_000001.11:g.[");
+    for (size_t i = 0; i < variants; ++i)
+    {
+        len += describe(str + len, size - len, i);
+        str[len] = i + 1 < variants ? ';' : ']';
+        len += 1;
+    } // for
+    str[len] = '\0';
+    return str;
+} // allele
+
+
+static int
+run(HGVS_Result* const result, size_t const variants)
+{
+    if (variants == 0)
+    {
+        return -1;
+    } // if
+    char* const str = allele(variants);
+    size_t const len = str != NULL ? strlen(str) : 0;
+    char* const buf = malloc(len + 1);
+    if (str == NULL || buf == NULL)
+    {
+        free(str);
+        free(buf);
+        return -1;
+    } // if
+    size_t const runs = variants < TOTAL ? TOTAL / variants : 1;
+
+    double start = now();
+    for (size_t i = 0; i < runs; ++i)
+    {
+        HGVS_result_parse_n(result, str, len);
+    } // for
+    double const parse = now() - start;
+
+    HGVS_Node const* const root = HGVS_result_root(result);
+    HGVS_Node const* const node = HGVS_node_right(result, root);
+    if (!HGVS_result_accepted(result) || HGVS_node_data(result, node) != variants)
+    {
+        free(str);
+        free(buf);
+        return -1;
+    } // if
+
+    size_t sum = 0;
+    start = now();
+    for (size_t i = 0; i < runs; ++i)
+    {
+        for (size_t j = 0; j < variants; ++j)
+        {
+            sum += HGVS_node_offset(result, HGVS_node_item(result, node, j));
+        } // for
+    } // for
+    double const visit = now() - start;
+
+    start = now();
+    for (size_t i = 0; i < runs; ++i)
+    {
+        sum += HGVS_result_canonical(result, buf, len + 1);
+    } // for
+    double const write = now() - start;
+
+    double const count = (double) runs * variants;
+    sink = sum;
+    printf("%zu\t%.1f\t%.1f\t%.2f\t%.1f\n", variants,
+           parse / count,
+           (double) HGVS_result_freeze(result, NULL, 0) / variants,
+           visit / count,
+           write / count);
+    free(str);
+    free(buf);
+    return 0;
+} // run
+
+
+int
+main(int argc, char* argv[])
+{
+    HGVS_Result* const result = HGVS_result_create();
+    if (result == NULL)
+    {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return EXIT_FAILURE;
+    } // if
+
+    // all per variant
+    printf("variants\tns to parse\tbytes frozen\tns to visit\tns to write\n");
+    int ret = 0;
+    for (int i = 1; i < argc && ret == 0; ++i)
+    {
+        ret = run(result, strtoull(argv[i], NULL, 10));
+    } // for
+    for (size_t i = 0; argc <= 1 && i < sizeof(VARIANTS) / sizeof(VARIANTS[0]) && ret == 0; ++i)
+    {
+        ret = run(result, VARIANTS[i]);
+    } // for
+    if (ret != 0)
+    {
+        fprintf(stderr, "%s: failed\n", argv[0]);
+    } // if
+
+    HGVS_result_destroy(result);
+    return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+} // main
@@ -0,0 +1,75 @@
+#define _POSIX_C_SOURCE 200809L
+
+
+#include <stddef.h>
+#include <stdio.h>
+#include <unistd.h>
+
+
+// Counts the calls of malloc(), calloc(), realloc() and free() of any
+// program it is preloaded into, and writes them to stderr when the
+// program exits. It forwards to the allocator of glibc, so it needs no
+// dlsym() (which allocates itself). Usage:
+//     LD_PRELOAD=bench/allocs.so ./a.out 'NG_012232.1:g.19_21del'
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void  __libc_free(void* ptr);
+
+
+static size_t mallocs  = 0;
+static size_t callocs  = 0;
+static size_t reallocs = 0;
+static size_t frees    = 0;
+
+
+void*
+malloc(size_t const size)
+{
+    __atomic_fetch_add(&mallocs, 1, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+} // malloc
+
+
+void*
+calloc(size_t const count, size_t const size)
+{
+    __atomic_fetch_add(&callocs, 1, __ATOMIC_RELAXED);
+    return __libc_calloc(count, size);
+} // calloc
+
+
+void*
+realloc(void* const ptr, size_t const size)
+{
+    __atomic_fetch_add(&reallocs, 1, __ATOMIC_RELAXED);
+    return __libc_realloc(ptr, size);
+} // realloc
+
+
+void
+free(void* const ptr)
+{
+    if (ptr != NULL)
+    {
+        __atomic_fetch_add(&frees, 1, __ATOMIC_RELAXED);
+    } // if
+    __libc_free(ptr);
+} // free
+
+
+// written with write(), as a stream would allocate its buffer while
+// it is counted
+__attribute__((destructor))
+static void
+report(void)
+{
+    char buffer[128];
+    int const len = snprintf(buffer, sizeof(buffer), "allocs\tmalloc %zu\tcalloc %zu\trealloc %zu\tfree %zu\n",
+                             mallocs, callocs, reallocs, frees);
+    if (len > 0)
+    {
+        ssize_t const written = write(STDERR_FILENO, buffer, len);
+        (void) written;
+    } // if
+} // report
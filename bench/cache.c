@@ -0,0 +1,180 @@
+#define _POSIX_C_SOURCE 200809L
+
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+#include "../include/hgvs.h"
+
+
+// Parses draws from a Zipf distribution over distinct synthetic
+// descriptions, without and with caches of several sizes, and reports
+// the time per description and the hit rate. Usage:
+//     bench/cache [distinct [draws [exponent [seed]]]]
+static size_t const DISTINCT = 100000;
+static size_t const DRAWS    = 1000000;
+static double const EXPONENT = 1.0;
+
+
+static uint64_t
+next(uint64_t* const state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+} // next
+
+
+// one of a few common shapes, unique per index
+static int
+describe(char* const buf, size_t const size, size_t const i)
+{
+    static char const NT[] = "ACGT";
+    size_t const pos = 100 + i;
+    switch (i % 6)
+    {
+        case 0:
+            return snprintf(buf, size, "NM_%06zu.1:c.%zu%c>%c", i % 9973, pos, NT[i % 4], NT[(i + 1) % 4]);
+        case 1:
+            return snprintf(buf, size, "NC_0000%02zu.11:g.%zu_%zudel", 1 + i % 22, pos, pos + 3);
+        case 2:
+            return snprintf(buf, size, "NM_%06zu.2:c.%zu+%zudup", i % 9973, pos, 1 + i % 50);
+        case 3:
+            return snprintf(buf, size, "NG_%06zu.1(NM_%06zu.1):c.%zu_%zudelinsTTGA", i % 997, i % 9973, pos, pos + 1);
+        case 4:
+            return snprintf(buf, size, "LRG_%zut1:c.%zu_%zuins%c%c%c", i % 997, pos, pos + 1, NT[i % 4], NT[(i / 4) % 4], NT[(i / 16) % 4]);
+        default:
+            return snprintf(buf, size, "NC_0000%02zu.11:g.[%zu%c>%c;%zu_%zudel]", 1 + i % 22, pos, NT[i % 4], NT[(i + 2) % 4], pos + 10, pos + 12);
+    } // switch
+} // describe
+
+
+static double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+} // now
+
+
+static void
+run(HGVS_Result* const  result,
+    char** const        descriptions,
+    size_t const* const draws,
+    size_t const        count,
+    size_t const        entries,
+    bool const          trees)
+{
+    HGVS_Cache* const cache = entries > 0 ? HGVS_cache_create(entries, trees) : NULL;
+    if (entries > 0 && cache == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return;
+    } // if
+
+    double const start = now();
+    for (size_t i = 0; i < count; ++i)
+    {
+        char const* const str = descriptions[draws[i]];
+        if (cache != NULL)
+        {
+            HGVS_Verdict verdict;
+            HGVS_cache_parse_n(cache, result, str, strlen(str), &verdict);
+        } // if
+        else
+        {
+            HGVS_result_parse(result, str);
+        } // else
+    } // for
+    double const ns = now() - start;
+
+    size_t const hits = cache != NULL ? HGVS_cache_hits(cache) : 0;
+    printf("%zu\t%s\t%.1f\t%.3f\n", entries, trees ? "trees" : "verdicts", ns / count, (double) hits / count);
+    HGVS_cache_destroy(cache);
+} // run
+
+
+int
+main(int argc, char* argv[])
+{
+    size_t const distinct = argc > 1 ? strtoull(argv[1], NULL, 10) : DISTINCT;
+    size_t const count = argc > 2 ? strtoull(argv[2], NULL, 10) : DRAWS;
+    double const exponent = argc > 3 ? strtod(argv[3], NULL) : EXPONENT;
+    uint64_t state = argc > 4 ? strtoull(argv[4], NULL, 10) : 1;
+    if (distinct == 0 || count == 0 || state == 0)
+    {
+        fprintf(stderr, "usage: %s [distinct [draws [exponent [seed]]]]\n", argv[0]);
+        return EXIT_FAILURE;
+    } // if
+
+    char** const descriptions = calloc(distinct, sizeof(*descriptions));
+    double* const cumulative = malloc(distinct * sizeof(*cumulative));
+    size_t* const draws = malloc(count * sizeof(*draws));
+    HGVS_Result* const result = HGVS_result_create();
+    if (descriptions == NULL || cumulative == NULL || draws == NULL || result == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    } // if
+
+    double total = 0;
+    for (size_t i = 0; i < distinct; ++i)
+    {
+        char buf[128];
+        describe(buf, sizeof(buf), i);
+        descriptions[i] = strdup(buf);
+        total += 1 / pow(i + 1, exponent);
+        cumulative[i] = total;
+    } // for
+
+    // the rank of a uniform draw by bisection of the cumulative weights
+    for (size_t i = 0; i < count; ++i)
+    {
+        double const u = (next(&state) >> 11) * 0x1.0p-53 * total;
+        size_t low = 0;
+        size_t high = distinct - 1;
+        while (low < high)
+        {
+            size_t const mid = low + (high - low) / 2;
+            if (cumulative[mid] < u)
+            {
+                low = mid + 1;
+            } // if
+            else
+            {
+                high = mid;
+            } // else
+        } // while
+        draws[i] = low;
+    } // for
+
+    printf("distinct\t%zu\ndraws\t%zu\nexponent\t%.2f\n", distinct, count, exponent);
+    printf("entries\tkeeps\tns per description\thit rate\n");
+    run(result, descriptions, draws, count, 0, false);
+    for (size_t entries = distinct / 100; entries <= distinct; entries *= 10)
+    {
+        if (entries > 0)
+        {
+            run(result, descriptions, draws, count, entries, false);
+            run(result, descriptions, draws, count, entries, true);
+        } // if
+    } // for
+
+    for (size_t i = 0; i < distinct; ++i)
+    {
+        free(descriptions[i]);
+    } // for
+    free(descriptions);
+    free(cumulative);
+    free(draws);
+    HGVS_result_destroy(result);
+    return EXIT_SUCCESS;
+} // main
@@ -0,0 +1,89 @@
+#define _POSIX_C_SOURCE 200809L
+
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+#include "../include/hgvs.h"
+
+
+// Parses the first field of every line of the given files (or stdin)
+// and reports the parser's counters (see HGVS_result_print_stats()) and
+// the time per description. Built by `make bench` with OPTIONS=STATS.
+// With -r the descriptions are only recognized. Usage:
+//     bench/calls [-r] [file ...]
+static int
+parse_stream(HGVS_Result* const result, FILE* const stream, bool const recognize, size_t* const count)
+{
+    char* line = NULL;
+    size_t size = 0;
+    ssize_t len = 0;
+    while ((len = getline(&line, &size, stream)) != -1)
+    {
+        size_t const start = strspn(line, " \t");
+        size_t const tok = strcspn(line + start, " \t\r\n");
+        if (recognize)
+        {
+            HGVS_result_recognize_n(result, line + start, tok);
+        } // if
+        else
+        {
+            HGVS_result_parse_n(result, line + start, tok);
+        } // else
+        *count += 1;
+    } // while
+    free(line);
+    return ferror(stream) ? -1 : 0;
+} // parse_stream
+
+
+int
+main(int argc, char* argv[])
+{
+    HGVS_Result* const result = HGVS_result_create();
+    if (result == NULL)
+    {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return EXIT_FAILURE;
+    } // if
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    bool const recognize = argc > 1 && strcmp(argv[1], "-r") == 0;
+    int const first = recognize ? 2 : 1;
+
+    size_t count = 0;
+    int ret = 0;
+    if (argc <= first)
+    {
+        ret = parse_stream(result, stdin, recognize, &count);
+    } // if
+    for (int i = first; i < argc && ret == 0; ++i)
+    {
+        FILE* const stream = fopen(argv[i], "r");
+        if (stream == NULL)
+        {
+            perror(argv[i]);
+            ret = -1;
+            break;
+        } // if
+        ret = parse_stream(result, stream, recognize, &count);
+        fclose(stream);
+    } // for
+
+    struct timespec stop;
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    double const ns = (stop.tv_sec - start.tv_sec) * 1e9 + (stop.tv_nsec - start.tv_nsec);
+
+    printf("descriptions\t%zu\n", count);
+    printf("ns per description\t%.1f\n", count > 0 ? ns / count : 0.0);
+    HGVS_result_print_stats(stdout, result);
+
+    HGVS_result_destroy(result);
+    return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+} // main
@@ -0,0 +1,610 @@
+#define _POSIX_C_SOURCE 200809L
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#include "../include/hgvs.h"
+
+
+// Writes a synthetic corpus, one description per line, from the grammar
+// of src/hgvs_parser.c: substitutions, deletions, duplications,
+// insertions, deletion/insertions, inversions, conversions, repeats,
+// equals, uncertain ranges, compound alleles, and inserted parts that
+// are compounds or descriptions of their own, nested to the given depth.
+// Each shape is drawn with its weight in the mix; an invalid description
+// is a valid one mutated (truncated, or a character deleted, inserted or
+// replaced) until the parser rejects it. Every valid one is checked to
+// be accepted: the exit status is non-zero if any is not. The same
+// options and seed give the same corpus. Usage:
+//     bench/generate [-n lines] [-m shape=weight,...] [-d depth] [-l length] [-s seed]
+static size_t const LINES  = 100000;
+static size_t const DEPTH  = 2;
+static size_t const LENGTH = 8;     // of sequences, at most
+static size_t const NESTING_LIMIT = 64;  // of the parser
+static size_t const MUTATIONS     = 8;   // of a valid description, before another is drawn
+
+
+// the shapes of descriptions and their default weights
+#define SHAPES(X)              \
+    X(substitution,       25)  \
+    X(deletion,           15)  \
+    X(duplication,        10)  \
+    X(insertion,          10)  \
+    X(deletion_insertion, 10)  \
+    X(inversion,           3)  \
+    X(conversion,          2)  \
+    X(repeat,              5)  \
+    X(equal,               2)  \
+    X(uncertain,           5)  \
+    X(allele,              8)  \
+    X(invalid,             5)
+
+
+enum Shape
+{
+#define X(name, weight) SHAPE_##name,
+    SHAPES(X)
+#undef X
+    SHAPE_COUNT
+};
+
+
+static char const* const SHAPE_NAMES[] =
+{
+#define X(name, weight) [SHAPE_##name] = #name,
+    SHAPES(X)
+#undef X
+};
+
+
+typedef struct Reference
+{
+    char const* str;
+    char        system;
+} Reference;
+
+
+static Reference const REFERENCES[] =
+{
+    {"NC_000023.10",             'g'},
+    {"NC_000023.11",             'g'},
+    {"NC_000001.11",             'g'},
+    {"NG_012232.1",              'g'},
+    {"NG_012232.1(NM_004006.1)", 'c'},
+    {"NM_004006.1",              'c'},
+    {"NM_004006.2",              'c'},
+    {"LRG_199t1",                'c'},
+    {"ENST00000357033.8",        'c'},
+}; // REFERENCES
+
+
+// what a mutation may put into a description
+static char const MUTANTS[] = "()[];_:>+-*?=.ACGTNdelinsupvo0123456789";
+
+
+typedef struct Generator
+{
+    uint64_t     state;
+    size_t       weights[SHAPE_COUNT];
+    size_t       total;    // of the weights
+    size_t       depth;
+    size_t       length;
+    HGVS_Output* output;
+} Generator;
+
+
+static uint64_t
+next(uint64_t* const state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+} // next
+
+
+// uniform in [0, count)
+static size_t
+below(Generator* const generator, size_t const count)
+{
+    return next(&generator->state) % count;
+} // below
+
+
+static bool
+chance(Generator* const generator, size_t const percent)
+{
+    return below(generator, 100) < percent;
+} // chance
+
+
+// a shape by its weight; without alleles and invalid descriptions for
+// the variants of an allele or a nested description
+static enum Shape
+draw(Generator* const generator, bool const variant)
+{
+    size_t total = generator->total;
+    if (variant)
+    {
+        total -= generator->weights[SHAPE_allele] + generator->weights[SHAPE_invalid];
+        if (total == 0)
+        {
+            return SHAPE_substitution;
+        } // if
+    } // if
+
+    size_t pick = below(generator, total);
+    for (int shape = 0; shape < SHAPE_COUNT; ++shape)
+    {
+        if (variant && (shape == SHAPE_allele || shape == SHAPE_invalid))
+        {
+            continue;
+        } // if
+        if (pick < generator->weights[shape])
+        {
+            return shape;
+        } // if
+        pick -= generator->weights[shape];
+    } // for
+    return SHAPE_substitution;
+} // draw
+
+
+static void
+sequence(Generator* const generator)
+{
+    static char const NT[] = "ACGT";
+    size_t const len = 1 + below(generator, generator->length);
+    for (size_t i = 0; i < len; ++i)
+    {
+        HGVS_output_putc(generator->output, NT[below(generator, 4)]);
+    } // for
+} // sequence
+
+
+// A position, and for a coding one sometimes upstream or downstream,
+// with an intronic offset or unknown.
+static size_t
+point(Generator* const generator, bool const coding, size_t const position)
+{
+    if (coding && chance(generator, 5))
+    {
+        HGVS_output_putc(generator->output, chance(generator, 50) ? '*' : '-');
+    } // if
+    if (chance(generator, 2))
+    {
+        HGVS_output_putc(generator->output, '?');
+    } // if
+    else
+    {
+        HGVS_output_decimal(generator->output, position);
+    } // else
+    if (coding && chance(generator, 20))
+    {
+        HGVS_output_putc(generator->output, chance(generator, 50) ? '+' : '-');
+        HGVS_output_decimal(generator->output, 1 + below(generator, 250));
+    } // if
+    return position;
+} // point
+
+
+static size_t
+position(Generator* const generator, bool const coding)
+{
+    return 1 + below(generator, coding ? 10000 : 50000000);
+} // position
+
+
+// a point, or a range of the given length at most
+static void
+location(Generator* const generator, bool const coding, bool const range, size_t const span)
+{
+    size_t const start = point(generator, coding, position(generator, coding));
+    if (range)
+    {
+        HGVS_output_putc(generator->output, '_');
+        point(generator, coding, start + 1 + below(generator, span));
+    } // if
+} // location
+
+
+// as (4071+1_4072-1)_(5154+1_5155-1)
+static void
+uncertain(Generator* const generator, bool const coding)
+{
+    size_t const start = position(generator, coding);
+    size_t const end = start + 10 + below(generator, 1000);
+    HGVS_output_putc(generator->output, '(');
+    point(generator, coding, start);
+    HGVS_output_putc(generator->output, '_');
+    point(generator, coding, start + 1);
+    HGVS_output_puts(generator->output, ")_(");
+    point(generator, coding, end);
+    HGVS_output_putc(generator->output, '_');
+    point(generator, coding, end + 1);
+    HGVS_output_putc(generator->output, ')');
+} // uncertain
+
+
+static void
+description(Generator* const generator, enum Shape const shape, size_t const depth);
+
+
+static void
+insert(Generator* const generator, size_t const depth)
+{
+    size_t const pick = below(generator, 100);
+    if (pick < 50)
+    {
+        sequence(generator);
+    } // if
+    else if (pick < 60)
+    {
+        sequence(generator);
+        HGVS_output_putc(generator->output, '[');
+        HGVS_output_decimal(generator->output, 2 + below(generator, 20));
+        HGVS_output_putc(generator->output, ']');
+    } // if
+    else if (pick < 65)
+    {
+        HGVS_output_putc(generator->output, '(');
+        HGVS_output_decimal(generator->output, 1 + below(generator, 100));
+        HGVS_output_putc(generator->output, ')');
+    } // if
+    else if (pick < 80 || depth == 0)
+    {
+        location(generator, false, true, 100);
+        if (chance(generator, 30))
+        {
+            HGVS_output_puts(generator->output, "inv");
+        } // if
+    } // if
+    else
+    {
+        description(generator, draw(generator, true), depth - 1);
+    } // else
+} // insert
+
+
+// an insert, or a compound of them
+static void
+inserted(Generator* const generator, size_t const depth)
+{
+    if (!chance(generator, 20))
+    {
+        insert(generator, depth);
+        return;
+    } // if
+
+    size_t const count = 2 + below(generator, 3);
+    HGVS_output_putc(generator->output, '[');
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i > 0)
+        {
+            HGVS_output_putc(generator->output, ';');
+        } // if
+        insert(generator, depth);
+    } // for
+    HGVS_output_putc(generator->output, ']');
+} // inserted
+
+
+static void
+variant(Generator* const  generator,
+        enum Shape const  shape,
+        bool const        coding,
+        size_t const      depth)
+{
+    HGVS_Output* const output = generator->output;
+    switch (shape)
+    {
+        case SHAPE_substitution:
+        {
+            static char const NT[] = "ACGT";
+            size_t const ref = below(generator, 4);
+            location(generator, coding, false, 0);
+            HGVS_output_putc(output, NT[ref]);
+            HGVS_output_putc(output, '>');
+            HGVS_output_putc(output, NT[(ref + 1 + below(generator, 3)) % 4]);
+            break;
+        }
+        case SHAPE_deletion:
+            location(generator, coding, chance(generator, 60), 1000);
+            HGVS_output_puts(output, "del");
+            if (chance(generator, 20))
+            {
+                sequence(generator);
+            } // if
+            break;
+        case SHAPE_duplication:
+            location(generator, coding, chance(generator, 60), 100);
+            HGVS_output_puts(output, "dup");
+            break;
+        case SHAPE_insertion:
+            location(generator, coding, true, 1);
+            HGVS_output_puts(output, "ins");
+            inserted(generator, depth);
+            break;
+        case SHAPE_deletion_insertion:
+            location(generator, coding, chance(generator, 60), 100);
+            HGVS_output_puts(output, "delins");
+            inserted(generator, depth);
+            break;
+        case SHAPE_inversion:
+            location(generator, coding, true, 1000);
+            HGVS_output_puts(output, "inv");
+            break;
+        case SHAPE_conversion:
+            location(generator, coding, true, 1000);
+            HGVS_output_puts(output, "con");
+            if (depth > 0)
+            {
+                description(generator, SHAPE_COUNT, depth - 1);
+            } // if
+            else
+            {
+                location(generator, false, true, 1000);
+            } // else
+            break;
+        case SHAPE_repeat:
+        {
+            location(generator, coding, chance(generator, 70), 100);
+            size_t const units = chance(generator, 70) ? 1 : 2 + below(generator, 2);
+            for (size_t i = 0; i < units; ++i)
+            {
+                sequence(generator);
+                HGVS_output_putc(output, '[');
+                HGVS_output_decimal(output, 1 + below(generator, 40));
+                HGVS_output_putc(output, ']');
+            } // for
+            break;
+        }
+        case SHAPE_equal:
+            location(generator, coding, chance(generator, 30), 100);
+            HGVS_output_putc(output, '=');
+            break;
+        case SHAPE_uncertain:
+            uncertain(generator, coding);
+            HGVS_output_puts(output, chance(generator, 70) ? "del" : "dup");
+            break;
+        default:
+            // a slice
+            location(generator, coding, true, 1000);
+            break;
+    } // switch
+} // variant
+
+
+// A description of the given shape; an allele has 2 to 6 variants, and
+// SHAPE_COUNT makes a slice (as conversions and nested descriptions do).
+static void
+description(Generator* const generator, enum Shape const shape, size_t const depth)
+{
+    HGVS_Output* const output = generator->output;
+    Reference const* const reference = &REFERENCES[below(generator, sizeof(REFERENCES) / sizeof(REFERENCES[0]))];
+    bool const coding = reference->system == 'c';
+    HGVS_output_puts(output, reference->str);
+    HGVS_output_putc(output, ':');
+    HGVS_output_putc(output, reference->system);
+    HGVS_output_putc(output, '.');
+
+    if (shape != SHAPE_allele)
+    {
+        variant(generator, shape, coding, depth);
+        return;
+    } // if
+
+    size_t const count = 2 + below(generator, 5);
+    HGVS_output_putc(output, '[');
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i > 0)
+        {
+            HGVS_output_putc(output, ';');
+        } // if
+        variant(generator, draw(generator, true), coding, depth);
+    } // for
+    HGVS_output_putc(output, ']');
+} // description
+
+
+// truncates the description, or deletes, inserts or replaces one of its
+// characters
+static void
+mutate(Generator* const generator)
+{
+    HGVS_Output* const output = generator->output;
+    size_t const at = below(generator, output->len);
+    char const mutant = MUTANTS[below(generator, sizeof(MUTANTS) - 1)];
+    switch (below(generator, 4))
+    {
+        case 0:
+            output->len = at > 0 ? at : 1;
+            break;
+        case 1:
+            memmove(output->data + at, output->data + at + 1, output->len - at - 1);
+            output->len -= 1;
+            break;
+        case 2:
+            if (HGVS_output_putc(output, mutant) > 0)
+            {
+                memmove(output->data + at + 1, output->data + at, output->len - at - 1);
+                output->data[at] = mutant;
+            } // if
+            break;
+        default:
+            output->data[at] = mutant;
+            break;
+    } // switch
+} // mutate
+
+
+// One line; false if a description meant to be valid is rejected.
+static bool
+generate(Generator* const generator, HGVS_Result* const result)
+{
+    HGVS_Output* const output = generator->output;
+    enum Shape const shape = draw(generator, false);
+    for (;;)
+    {
+        output->len = 0;
+        description(generator, shape == SHAPE_invalid ? draw(generator, true) : shape, generator->depth);
+        if (output->error)
+        {
+            return false;
+        } // if
+        if (shape != SHAPE_invalid)
+        {
+            return HGVS_result_recognize_n(result, output->data, output->len) == 0;
+        } // if
+
+        for (size_t i = 0; i < MUTATIONS && output->len > 0; ++i)
+        {
+            mutate(generator);
+            if (HGVS_result_recognize_n(result, output->data, output->len) != 0)
+            {
+                return true;
+            } // if
+        } // for
+    } // for
+} // generate
+
+
+// name=weight,...; false if any is not a shape
+static bool
+mix(Generator* const generator, char* const str)
+{
+    for (char* tok = strtok(str, ","); tok != NULL; tok = strtok(NULL, ","))
+    {
+        char* const eq = strchr(tok, '=');
+        if (eq == NULL)
+        {
+            return false;
+        } // if
+        *eq = '\0';
+        int shape = 0;
+        while (shape < SHAPE_COUNT && strcmp(tok, SHAPE_NAMES[shape]) != 0)
+        {
+            shape += 1;
+        } // while
+        if (shape == SHAPE_COUNT)
+        {
+            return false;
+        } // if
+        generator->weights[shape] = strtoull(eq + 1, NULL, 10);
+    } // for
+    return true;
+} // mix
+
+
+static void
+usage(char const* const name)
+{
+    fprintf(stderr, "usage: %s [-n lines] [-m shape=weight,...] [-d depth] [-l length] [-s seed]\nshapes:", name);
+    for (int shape = 0; shape < SHAPE_COUNT; ++shape)
+    {
+        fprintf(stderr, " %s", SHAPE_NAMES[shape]);
+    } // for
+    fprintf(stderr, "\n");
+} // usage
+
+
+int
+main(int argc, char* argv[])
+{
+    HGVS_Output output;
+    HGVS_output_init(&output, NULL, HGVS_Format_plain);
+    Generator generator = {
+        .state   = 1,
+        .weights = {
+#define X(name, weight) [SHAPE_##name] = weight,
+            SHAPES(X)
+#undef X
+        },
+        .total   = 0,
+        .depth   = DEPTH,
+        .length  = LENGTH,
+        .output  = &output
+    }; // generator
+    size_t lines = LINES;
+
+    bool valid = true;
+    int i = 1;
+    for (; valid && i + 1 < argc && argv[i][0] == '-'; i += 2)
+    {
+        char const* const arg = argv[i + 1];
+        switch (argv[i][1])
+        {
+            case 'n':
+                lines = strtoull(arg, NULL, 10);
+                break;
+            case 'm':
+                valid = mix(&generator, argv[i + 1]);
+                break;
+            case 'd':
+                generator.depth = strtoull(arg, NULL, 10);
+                break;
+            case 'l':
+                generator.length = strtoull(arg, NULL, 10);
+                break;
+            case 's':
+                generator.state = strtoull(arg, NULL, 10);
+                break;
+            default:
+                valid = false;
+                break;
+        } // switch
+        valid = valid && argv[i][2] == '\0';
+    } // for
+    for (int shape = 0; shape < SHAPE_COUNT; ++shape)
+    {
+        generator.total += generator.weights[shape];
+    } // for
+    if (!valid || i < argc || generator.total == 0 || generator.depth >= NESTING_LIMIT ||
+        generator.length == 0 || generator.state == 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    } // if
+
+    HGVS_Result* const result = HGVS_result_create();
+    if (result == NULL)
+    {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return EXIT_FAILURE;
+    } // if
+
+    int ret = EXIT_SUCCESS;
+    for (size_t j = 0; j < lines; ++j)
+    {
+        if (!generate(&generator, result))
+        {
+            if (output.error)
+            {
+                fprintf(stderr, "%s: out of memory\n", argv[0]);
+                ret = EXIT_FAILURE;
+                break;
+            } // if
+            fprintf(stderr, "%s: rejected %.*s: %s at %zu\n", argv[0], (int) output.len, output.data,
+                    HGVS_result_error_message(result), HGVS_result_error_offset(result));
+            ret = EXIT_FAILURE;
+        } // if
+        HGVS_output_putc(&output, '\n');
+        fwrite(output.data, 1, output.len, stdout);
+    } // for
+
+    if (fflush(stdout) != 0 || ferror(stdout))
+    {
+        perror(argv[0]);
+        ret = EXIT_FAILURE;
+    } // if
+    HGVS_output_destroy(&output);
+    HGVS_result_destroy(result);
+    return ret;
+} // main
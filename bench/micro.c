@@ -0,0 +1,306 @@
+#define _POSIX_C_SOURCE 200809L
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+// The parser is compiled into this file, so its productions can be
+// called one at a time, and with its heap allocations counted.
+static size_t allocations = 0;
+
+
+static void*
+counted_malloc(size_t const size)
+{
+    allocations += 1;
+    return malloc(size);
+} // counted_malloc
+
+
+static void*
+counted_realloc(void* const ptr, size_t const size)
+{
+    allocations += 1;
+    return realloc(ptr, size);
+} // counted_realloc
+
+
+#define malloc(size)       counted_malloc(size)
+#define realloc(ptr, size) counted_realloc(ptr, size)
+#include "../src/hgvs_parser.c"
+#undef malloc
+#undef realloc
+
+// the lexer itself, not its counting versions of a STATS build
+#undef match_alpha
+#undef match_char
+#undef match_number
+#undef match_sequence
+#undef match_identifier
+#undef match_string
+#undef peek_string
+#undef skip_identifier
+
+
+// Times every match_* function of the lexer and the major productions
+// of the grammar on fixed inputs, each of which it matches completely,
+// and reports per operation the time, the input bytes per nanosecond,
+// the allocations (nodes of the tree) and their bytes, and the calls of
+// malloc() and realloc(), which amortize to nothing as a result reuses
+// its memory. The long runs that the lexer scans a vector at a time (a
+// 4096-byte inserted sequence, a 64 KiB identifier) are built at start
+// by repeating a pattern. Each is run for
+// about 20 ms, five times; the fastest run counts. Optionally only
+// those whose name contains the filter. Usage:
+//     bench/micro [filter]
+static double const RUN_NS  = 2e7;
+static size_t const REPEATS = 5;
+
+
+// keeps the results from being optimized away
+static volatile size_t sink = 0;
+
+// each operation loads its input through this, so none can be hoisted
+// out of the loop
+static char const* volatile source = NULL;
+
+
+static double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+} // now
+
+
+// One loop per lexer function, so each is inlined as in the parser; the
+// result is the sum of the values matched and the characters consumed.
+#define LEXER(X)                                                                        \
+    X(match_alpha, size_t ch = 0; res += match_alpha(&ptr, end, &ch) + ch)              \
+    X(match_char, res += match_char(&ptr, end, '['))                                    \
+    X(match_number, size_t num = 0; res += match_number(&ptr, end, &num) + num)         \
+    X(match_sequence, size_t len = 0; res += match_sequence(&ptr, end, &len) + len)     \
+    X(match_identifier, size_t len = 0; res += match_identifier(&ptr, end, &len) + len) \
+    X(match_string, res += match_string(&ptr, end, "delins"))                           \
+    X(peek_string, res += peek_string(ptr, end, "delins"))
+
+
+#define X(name, call)                                                                   \
+static size_t                                                                           \
+lexer_##name(Parser* const parser, size_t const len, size_t const runs)                 \
+{                                                                                       \
+    (void) parser;                                                                      \
+    size_t res = 0;                                                                     \
+    for (size_t i = 0; i < runs; ++i)                                                   \
+    {                                                                                   \
+        char const* ptr = source;                                                       \
+        char const* const start = ptr;                                                  \
+        char const* const end = ptr + len;                                              \
+        call;                                                                           \
+        res += ptr - start;                                                             \
+    }                                                                                   \
+    return res;                                                                         \
+}
+LEXER(X)
+#undef X
+
+
+typedef Index (*Production)(Parser* const parser, char const** const ptr);
+
+
+// one production at a time on a fresh parse, as it is called when
+// parsing a description
+static size_t
+production(Parser* const    parser,
+           Production const call,
+           size_t const     len,
+           size_t const     runs)
+{
+    size_t res = 0;
+    for (size_t i = 0; i < runs; ++i)
+    {
+        char const* ptr = source;
+        parser_reset(parser, ptr, len);
+        res += call(parser, &ptr);
+    } // for
+    return res;
+} // production
+
+
+typedef struct Case
+{
+    char const* name;
+    char const* input;
+    size_t      (*lexer)(Parser* const parser, size_t const len, size_t const runs);
+    Production  production;
+    size_t      size;  // if not 0, the input is repeated to this many bytes
+} Case;
+
+
+static Case const CASES[] =
+{
+    {"match_alpha",      "c",                                         lexer_match_alpha,      NULL,                0},
+    {"match_char",       "[",                                         lexer_match_char,       NULL,                0},
+    {"match_number",     "12",                                        lexer_match_number,     NULL,                0},
+    {"match_number",     "33274278",                                  lexer_match_number,     NULL,                0},
+    {"match_number",     "123456789",                                 lexer_match_number,     NULL,                0},
+    {"match_number",     "18446744073709551615",                      lexer_match_number,     NULL,                0},
+    {"match_sequence",   "ACGT",                                      lexer_match_sequence,   NULL,                0},
+    {"match_sequence",   "ACGTACGTACGTACGTACGTACGTACGTACGTACGTACGT",  lexer_match_sequence,   NULL,                0},
+    {"match_sequence",   "ACGTRYKMSWBDHVN",                           lexer_match_sequence,   NULL,             4096},
+    {"match_identifier", "NM_004006.1",                               lexer_match_identifier, NULL,                0},
+    {"match_identifier", "ENST00000357033.8_with_a_long_suffix",      lexer_match_identifier, NULL,                0},
+    {"match_identifier", "NG_012232.1_",                              lexer_match_identifier, NULL,            65536},
+    {"match_string",     "delins",                                    lexer_match_string,     NULL,                0},
+    {"peek_string",      "delins",                                    lexer_peek_string,      NULL,                0},
+
+    {"number",           "123456789",                                 NULL,                   number,              0},
+    {"identifier",       "NM_004006.1",                               NULL,                   identifier,          0},
+    {"reference",        "NG_012232.1(NM_004006.1)",                  NULL,                   reference,           0},
+    {"point",            "*183+48",                                   NULL,                   point,               0},
+    {"uncertain_point",  "(100_200)",                                 NULL,                   uncertain_point,     0},
+    {"location",         "183",                                       NULL,                   location,            0},
+    {"location",         "183_186+48",                                NULL,                   location,            0},
+    {"location",         "(100_200)_(300_?)",                         NULL,                   location,            0},
+    {"location",         "(31060227_31100351)_(33274278_33417151)",   NULL,                   location,            0},
+    {"insert",           "ACGTACGT",                                  NULL,                   insert,              0},
+    {"inserted",         "[A;10_20;ACG[5]]",                          NULL,                   inserted,            0},
+    {"inserted",         "[NM_004006.1:c.100_200;T]",                 NULL,                   inserted,            0},
+    {"variant",          "183_186+48delinsTT",                        NULL,                   variant,             0},
+    {"allele",           "[19_21del;22A>C;30dup]",                    NULL,                   allele,              0},
+    {"allele",           "[19_21del;(22_30)ins[A;5_9];40_41inv;50=]", NULL,                   allele,              0},
+    {"description",      "NG_012232.1(NM_004006.1):c.183_186+48del",  NULL,                   description,         0},
+    {"description",      "NC_000023.11:g.(31060227_31100351)_(33274278_33417151)del", NULL, description, 0},
+}; // CASES
+
+
+// the input of a case, which is copied if it is to be repeated
+static char*
+input_of(Case const* const test, size_t* const len)
+{
+    size_t const pattern = strlen(test->input);
+    *len = test->size != 0 ? test->size : pattern;
+    char* const input = malloc(*len + 1);
+    if (input == NULL)
+    {
+        return NULL;
+    } // if
+    for (size_t i = 0; i < *len; i += pattern)
+    {
+        memcpy(input + i, test->input, *len - i < pattern ? *len - i : pattern);
+    } // for
+    input[*len] = '\0';
+    return input;
+} // input_of
+
+
+static size_t
+run(Parser* const parser, Case const* const test, char const* const input, size_t const len, size_t const runs)
+{
+    source = input;
+    if (test->lexer != NULL)
+    {
+        return test->lexer(parser, len, runs);
+    } // if
+    return production(parser, test->production, len, runs);
+} // run
+
+
+// whether the case matches its whole input
+static bool
+matches(Parser* const parser, Case const* const test, char const* const input, size_t const len)
+{
+    if (test->lexer != NULL)
+    {
+        return true;
+    } // if
+    char const* ptr = input;
+    parser_reset(parser, ptr, len);
+    Index const node = test->production(parser, &ptr);
+    return node != NONE && !is_error(parser, node) && ptr == input + len;
+} // matches
+
+
+int
+main(int argc, char* argv[])
+{
+    char const* const filter = argc > 1 ? argv[1] : "";
+    HGVS_Result* const result = HGVS_result_create();
+    if (result == NULL)
+    {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return EXIT_FAILURE;
+    } // if
+    Parser* const parser = &result->parser;
+
+    int ret = EXIT_SUCCESS;
+    printf("function\tinput\tns/op\tbytes/ns\tallocations/op\tbytes/op\theap/op\n");
+    for (size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); ++i)
+    {
+        Case const* const test = &CASES[i];
+        if (strstr(test->name, filter) == NULL)
+        {
+            continue;
+        } // if
+        size_t len = 0;
+        char* const input = input_of(test, &len);
+        if (input == NULL)
+        {
+            fprintf(stderr, "%s: out of memory\n", argv[0]);
+            ret = EXIT_FAILURE;
+            break;
+        } // if
+        if (!matches(parser, test, input, len))
+        {
+            fprintf(stderr, "%s: %s() does not match %s\n", argv[0], test->name, test->input);
+            free(input);
+            ret = EXIT_FAILURE;
+            continue;
+        } // if
+        size_t const nodes = test->lexer != NULL ? 0 : parser->count - FIRST;
+
+        // as many runs as take about RUN_NS
+        size_t runs = 1;
+        for (;;)
+        {
+            double const start = now();
+            sink = run(parser, test, input, len, runs);
+            if (now() - start > RUN_NS / 10)
+            {
+                runs *= 10;
+                break;
+            } // if
+            runs *= 10;
+        } // for
+
+        double best = 0;
+        size_t const before = allocations;
+        for (size_t j = 0; j < REPEATS; ++j)
+        {
+            double const start = now();
+            sink = run(parser, test, input, len, runs);
+            double const ns = now() - start;
+            best = j == 0 || ns < best ? ns : best;
+        } // for
+        double const ops = (double) runs * REPEATS;
+
+        if (test->size != 0)
+        {
+            printf("%s\t%zu bytes of %s", test->name, len, test->input);
+        } // if
+        else
+        {
+            printf("%s\t%s", test->name, test->input);
+        } // else
+        printf("\t%.2f\t%.3f\t%zu\t%zu\t%.4f\n", best / runs, len * runs / best,
+               nodes, nodes * sizeof(Node), (allocations - before) / ops);
+        free(input);
+    } // for
+
+    HGVS_result_destroy(result);
+    return ret;
+} // main
@@ -0,0 +1,33 @@
+#!/bin/bash
+
+# Times batch mode on one corpus with every number of threads given
+# (by default 1, 2, 4 and 8), the best of three runs each, and reports
+# the speedup over the first. Without a corpus a million lines are
+# generated with bench/generate. Run from the root after `make release`
+# and `make bench`:
+#     bench/threads.sh [corpus [threads ...]]
+
+CORPUS=${1:-}
+shift
+THREADS=${@:-1 2 4 8}
+
+if [ -z "${CORPUS}" ]; then
+    CORPUS=$(mktemp)
+    trap 'rm -f "${CORPUS}"' EXIT
+    bench/generate -n 1000000 > "${CORPUS}" || exit 1
+fi
+LINES=$(wc -l < "${CORPUS}")
+
+echo -e "threads\tseconds\tdescriptions/s\tspeedup"
+BASE=
+for T in ${THREADS}; do
+    BEST=
+    for RUN in 1 2 3; do
+        START=$(date +%s.%N)
+        ./a.out -b -t "${T}" "${CORPUS}" > /dev/null
+        END=$(date +%s.%N)
+        BEST=$(echo "${START} ${END} ${BEST}" | awk '{ t = $2 - $1; print ($3 == "" || t < $3) ? t : $3 }')
+    done
+    BASE=${BASE:-${BEST}}
+    echo "${T} ${BEST} ${LINES} ${BASE}" | awk '{ printf("%d\t%.3f\t%.0f\t%.2f\n", $1, $2, $3 / $2, $4 / $2) }'
+done
@@ -0,0 +1,448 @@
+#define _POSIX_C_SOURCE 200809L
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+
+#include "../include/hgvs.h"
+
+
+// Parses corpora end to end as batch mode does (without the I/O): each
+// corpus is cycled through until the given number of descriptions is
+// parsed, in each of the modes of batch mode. Reports per corpus and
+// mode the descriptions and megabytes per second (of the fastest of
+// three passes), the peak RSS and the 99th percentile of the time per
+// description; every run is a process of its own, so its peak RSS is
+// its own. With -o the results are also
+// written to a baseline file; with -c they are compared to one, and
+// every run more than the threshold (in percent) slower, in throughput
+// or in p99, is flagged and makes the exit status 1. Usage:
+//     bench/throughput [-n lines] [-o baseline | -c baseline [-t threshold]] [corpus ...]
+static size_t const LINES     = 1000000;
+static size_t const REPEATS   = 3;
+static double const THRESHOLD = 10;
+
+static char const* const CORPORA[] = {"tests/varnomen.in", "tests/error.in", "tests/extra.in"};
+
+
+enum Mode
+{
+    MODE_RECOGNIZE,  // ./a.out -b
+    MODE_CANONICAL,  // ./a.out -b -n
+    MODE_JSON,       // ./a.out -b -j
+    MODE_COUNT
+};
+
+
+static char const* const MODE_NAMES[] =
+{
+    [MODE_RECOGNIZE] = "recognize",
+    [MODE_CANONICAL] = "canonical",
+    [MODE_JSON]      = "json",
+};
+
+
+// latencies in ns, one bucket per ns; slower ones all count as LATENCY_LIMIT
+enum
+{
+    LATENCY_LIMIT = 1 << 16
+};
+
+
+typedef struct Measurement
+{
+    double descriptions;  // per second
+    double megabytes;     // per second
+    double rss;           // peak, in KiB
+    double p99;           // in ns
+} Measurement;
+
+
+typedef struct Line
+{
+    char const* str;
+    size_t      len;   // of the first field
+    size_t      size;  // of the whole line
+} Line;
+
+
+// keeps the results from being optimized away
+static volatile size_t sink = 0;
+
+
+static double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+} // now
+
+
+// the lines of a file as batch mode splits them; NULL on failure
+static Line*
+load(char const* const path, char** const data, size_t* const count)
+{
+    FILE* const stream = fopen(path, "rb");
+    if (stream == NULL)
+    {
+        return NULL;
+    } // if
+    size_t len = 0;
+    size_t size = 0;
+    bool error = false;
+    *data = NULL;
+    for (;;)
+    {
+        if (len == size)
+        {
+            size = size > 0 ? 2 * size : 4096;
+            char* const tmp = realloc(*data, size);
+            if (tmp == NULL)
+            {
+                error = true;
+                break;
+            } // if
+            *data = tmp;
+        } // if
+        size_t const count = fread(*data + len, 1, size - len, stream);
+        len += count;
+        if (count == 0)
+        {
+            break;
+        } // if
+    } // for
+    error = error || ferror(stream);
+    fclose(stream);
+
+    Line* lines = error ? NULL : malloc((len + 1) * sizeof(*lines));
+    if (lines == NULL)
+    {
+        return NULL;
+    } // if
+    *count = 0;
+    char const* line = *data;
+    char const* const end = *data + len;
+    while (line < end)
+    {
+        char const* eol = memchr(line, '\n', end - line);
+        eol = eol != NULL ? eol + 1 : end;
+        char const* str = line;
+        while (str < eol && (*str == ' ' || *str == '\t'))
+        {
+            str += 1;
+        } // while
+        char const* tok = str;
+        while (tok < eol && *tok != ' ' && *tok != '\t' && *tok != '\r' && *tok != '\n')
+        {
+            tok += 1;
+        } // while
+        lines[*count].str = str;
+        lines[*count].len = tok - str;
+        lines[*count].size = eol - line;
+        *count += 1;
+        line = eol;
+    } // while
+    return lines;
+} // load
+
+
+static inline void
+parse(HGVS_Result* const  result,
+      HGVS_Output* const  output,
+      enum Mode const     mode,
+      Line const* const   line)
+{
+    output->len = 0;
+    switch (mode)
+    {
+        case MODE_RECOGNIZE:
+            HGVS_result_recognize_n(result, line->str, line->len);
+            break;
+        case MODE_CANONICAL:
+            HGVS_result_parse_n(result, line->str, line->len);
+            if (HGVS_result_accepted(result))
+            {
+                size_t const size = HGVS_result_canonical(result, NULL, 0);
+                char* const dst = HGVS_output_reserve(output, size + 1);
+                if (dst != NULL)
+                {
+                    output->len += HGVS_result_canonical(result, dst, size + 1);
+                } // if
+            } // if
+            break;
+        default:
+            HGVS_result_parse_n(result, line->str, line->len);
+            HGVS_result_write(output, result);
+            break;
+    } // switch
+} // parse
+
+
+// One run, in the child process: first a pass for the throughput, then
+// one that times every description.
+static int
+measure(Line const* const   lines,
+        size_t const        count,
+        size_t const        total,
+        enum Mode const     mode,
+        Measurement* const  measurement)
+{
+    HGVS_Result* const result = HGVS_result_create();
+    size_t* const latencies = calloc(LATENCY_LIMIT + 1, sizeof(*latencies));
+    if (result == NULL || latencies == NULL)
+    {
+        HGVS_result_destroy(result);
+        free(latencies);
+        return -1;
+    } // if
+    HGVS_result_trace(result, mode == MODE_JSON);
+    HGVS_Output output;
+    HGVS_output_init(&output, NULL, mode == MODE_JSON ? HGVS_Format_json : HGVS_Format_plain);
+
+    size_t bytes = 0;
+    double ns = 0;
+    for (size_t j = 0; j < REPEATS; ++j)
+    {
+        bytes = 0;
+        double const start = now();
+        for (size_t i = 0; i < total; ++i)
+        {
+            Line const* const line = &lines[i % count];
+            parse(result, &output, mode, line);
+            bytes += line->size;
+            sink = output.len;
+        } // for
+        double const pass = now() - start;
+        ns = j == 0 || pass < ns ? pass : ns;
+    } // for
+
+    for (size_t i = 0; i < total; ++i)
+    {
+        double const before = now();
+        parse(result, &output, mode, &lines[i % count]);
+        double const latency = now() - before;
+        latencies[latency < LATENCY_LIMIT ? (size_t) latency : LATENCY_LIMIT] += 1;
+    } // for
+
+    size_t seen = 0;
+    size_t p99 = 0;
+    while (p99 < LATENCY_LIMIT && (seen += latencies[p99]) < total - total / 100)
+    {
+        p99 += 1;
+    } // while
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    measurement->descriptions = total / ns * 1e9;
+    measurement->megabytes = bytes / ns * 1e9 / 1e6;
+    measurement->rss = usage.ru_maxrss;
+    measurement->p99 = p99;
+
+    HGVS_output_destroy(&output);
+    HGVS_result_destroy(result);
+    free(latencies);
+    return output.error ? -1 : 0;
+} // measure
+
+
+static int
+run(char const* const   path,
+    size_t const        total,
+    enum Mode const     mode,
+    Measurement* const  measurement)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return -1;
+    } // if
+    pid_t const pid = fork();
+    if (pid < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    } // if
+
+    if (pid == 0)
+    {
+        close(fds[0]);
+        char* data = NULL;
+        size_t count = 0;
+        Line* const lines = load(path, &data, &count);
+        int const ret = lines != NULL && count > 0 ? measure(lines, count, total, mode, measurement) : -1;
+        if (ret != 0 || write(fds[1], measurement, sizeof(*measurement)) != sizeof(*measurement))
+        {
+            _exit(EXIT_FAILURE);
+        } // if
+        _exit(EXIT_SUCCESS);
+    } // if
+
+    close(fds[1]);
+    ssize_t const read_ = read(fds[0], measurement, sizeof(*measurement));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return read_ == sizeof(*measurement) && WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+} // run
+
+
+// the baseline's measurement of a corpus in a mode; false if it has none
+static bool
+baseline(FILE* const         stream,
+         char const* const   path,
+         enum Mode const     mode,
+         Measurement* const  measurement)
+{
+    rewind(stream);
+    char* line = NULL;
+    size_t size = 0;
+    bool found = false;
+    while (!found && getline(&line, &size, stream) != -1)
+    {
+        if (line[0] == '#')
+        {
+            continue;
+        } // if
+        char* const mode_name = strchr(line, '\t');
+        char* const rest = mode_name != NULL ? strchr(mode_name + 1, '\t') : NULL;
+        if (rest == NULL)
+        {
+            continue;
+        } // if
+        *mode_name = '\0';
+        *rest = '\0';
+        size_t lines = 0;
+        found = strcmp(line, path) == 0 && strcmp(mode_name + 1, MODE_NAMES[mode]) == 0 &&
+                sscanf(rest + 1, "%zu %lf %lf %lf %lf", &lines, &measurement->descriptions,
+                       &measurement->megabytes, &measurement->rss, &measurement->p99) == 5;
+    } // while
+    free(line);
+    return found;
+} // baseline
+
+
+static void
+usage(char const* const name)
+{
+    fprintf(stderr, "usage: %s [-n lines] [-o baseline | -c baseline [-t threshold]] [corpus ...]\n", name);
+} // usage
+
+
+int
+main(int argc, char* argv[])
+{
+    size_t total = LINES;
+    double threshold = THRESHOLD;
+    char const* output = NULL;
+    char const* compare = NULL;
+    int first = 1;
+    for (; first < argc && argv[first][0] == '-' && first + 1 < argc; first += 2)
+    {
+        if (strcmp(argv[first], "-n") == 0)
+        {
+            total = strtoull(argv[first + 1], NULL, 10);
+        } // if
+        else if (strcmp(argv[first], "-o") == 0)
+        {
+            output = argv[first + 1];
+        } // if
+        else if (strcmp(argv[first], "-c") == 0)
+        {
+            compare = argv[first + 1];
+        } // if
+        else if (strcmp(argv[first], "-t") == 0)
+        {
+            threshold = strtod(argv[first + 1], NULL);
+        } // if
+        else
+        {
+            break;
+        } // else
+    } // for
+    if (total == 0 || (output != NULL && compare != NULL) || (first < argc && argv[first][0] == '-'))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    } // if
+
+    FILE* const stream = output != NULL ? fopen(output, "w") : compare != NULL ? fopen(compare, "r") : NULL;
+    if ((output != NULL || compare != NULL) && stream == NULL)
+    {
+        perror(output != NULL ? output : compare);
+        return EXIT_FAILURE;
+    } // if
+
+    char const* const* const corpora = first < argc ? (char const* const*) argv + first : CORPORA;
+    size_t const count = first < argc ? (size_t) (argc - first) : sizeof(CORPORA) / sizeof(CORPORA[0]);
+
+    static char const HEADER[] = "corpus\tmode\tlines\tdescriptions/s\tMB/s\tpeak RSS KiB\tp99 ns";
+    printf("%s%s\n", HEADER, compare != NULL ? "\tbaseline descriptions/s\tbaseline p99 ns\tverdict" : "");
+    if (output != NULL)
+    {
+        fprintf(stream, "# %s\n", HEADER);
+    } // if
+
+    int ret = EXIT_SUCCESS;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (access(corpora[i], R_OK) != 0)
+        {
+            perror(corpora[i]);
+            ret = EXIT_FAILURE;
+            continue;
+        } // if
+        for (int mode = 0; mode < MODE_COUNT; ++mode)
+        {
+            Measurement measurement;
+            if (run(corpora[i], total, mode, &measurement) != 0)
+            {
+                fprintf(stderr, "%s: cannot run %s\n", argv[0], corpora[i]);
+                ret = EXIT_FAILURE;
+                continue;
+            } // if
+            printf("%s\t%s\t%zu\t%.0f\t%.1f\t%.0f\t%.0f", corpora[i], MODE_NAMES[mode], total,
+                   measurement.descriptions, measurement.megabytes, measurement.rss, measurement.p99);
+            if (output != NULL)
+            {
+                fprintf(stream, "%s\t%s\t%zu\t%.0f\t%.1f\t%.0f\t%.0f\n", corpora[i], MODE_NAMES[mode], total,
+                        measurement.descriptions, measurement.megabytes, measurement.rss, measurement.p99);
+            } // if
+
+            Measurement base;
+            if (compare != NULL && baseline(stream, corpora[i], mode, &base))
+            {
+                bool const slower = measurement.descriptions < base.descriptions * (1 - threshold / 100) ||
+                                    measurement.p99 > base.p99 * (1 + threshold / 100);
+                printf("\t%.0f\t%.0f\t%s", base.descriptions, base.p99, slower ? "SLOWER" : "ok");
+                if (slower)
+                {
+                    ret = EXIT_FAILURE;
+                } // if
+            } // if
+            else if (compare != NULL)
+            {
+                printf("\t-\t-\tnew");
+            } // if
+            printf("\n");
+            fflush(stdout);
+        } // for
+    } // for
+
+    if (stream != NULL && fclose(stream) != 0)
+    {
+        perror(output != NULL ? output : compare);
+        ret = EXIT_FAILURE;
+    } // if
+    return ret;
+} // main
@@ -0,0 +1,37 @@
+#ifndef HGVS_HASH_H
+#define HGVS_HASH_H
+
+
+/*
+WARNING: this file is *not* to be included directly as it pollutes the
+         global namespace
+*/
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+// Mixes 8 bytes at a time; any input length. Never 0.
+static inline uint64_t
+hash(char const* const str, size_t const len)
+{
+    uint64_t res = len * UINT64_C(0x9E3779B97F4A7C15);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+        uint64_t word = 0;
+        memcpy(&word, str + i, 8);
+        res = (res ^ word) * UINT64_C(0xBF58476D1CE4E5B9);
+        res ^= res >> 31;
+    } // for
+    uint64_t tail = 0;
+    memcpy(&tail, str + i, len - i);
+    res = (res ^ tail) * UINT64_C(0x94D049BB133111EB);
+    res ^= res >> 29;
+    return res != 0 ? res : 1;
+} // hash
+
+
+#endif
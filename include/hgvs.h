@@ -20,8 +20,10 @@
 #endif
 
 
+#include "hgvs_cache.h"
 #include "hgvs_interface.h"
 #include "hgvs_parser.h"
+#include "hgvs_store.h"
 
 
 #endif
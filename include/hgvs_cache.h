@@ -0,0 +1,59 @@
+#ifndef HGVS_CACHE_H
+#define HGVS_CACHE_H
+
+
+#include <stdbool.h>
+#include <stddef.h>
+
+
+#include "hgvs_parser.h"
+
+
+// A bounded cache of verdicts (and optionally frozen trees) by input
+// string, evicting the least recently used. It is split in shards with
+// a lock each, so it can be shared by any number of threads, each with
+// its own result.
+typedef struct HGVS_Cache HGVS_Cache;
+
+
+typedef struct HGVS_Verdict
+{
+    bool        accepted;
+    bool        tree;           // the result holds the tree of this input
+    size_t      error_offset;
+    char const* error_message;  // NULL if accepted
+} HGVS_Verdict;
+
+
+// Keeps up to entries inputs; with trees also their parse trees, so a
+// hit gives a result as if the input was parsed.
+HGVS_Cache*
+HGVS_cache_create(size_t const entries, bool const trees);
+
+
+void
+HGVS_cache_destroy(HGVS_Cache* const cache);
+
+
+// As HGVS_result_parse_n(), but the input is parsed only if it is not
+// in the cache. The verdict is filled in always; the result holds the
+// tree of the input only if verdict->tree is set, which is always the
+// case with a cache with trees. Without, a miss is only recognized (see
+// HGVS_result_recognize_n()).
+int
+HGVS_cache_parse_n(HGVS_Cache* const   cache,
+                   HGVS_Result* const  result,
+                   char const* const   str,
+                   size_t const        len,
+                   HGVS_Verdict* const verdict);
+
+
+size_t
+HGVS_cache_hits(HGVS_Cache* const cache);
+
+
+size_t
+HGVS_cache_misses(HGVS_Cache* const cache);
+
+
+#endif
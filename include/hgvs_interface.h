@@ -2,8 +2,11 @@
 #define HGVS_INTERFACE_H
 
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #if defined(ANSI)
 #include <unistd.h>
@@ -33,6 +36,8 @@ enum HGVS_Format
 {
     HGVS_Format_plain,
     HGVS_Format_console,
+    HGVS_Format_canonical,  // plain, with sequences and coordinate systems in one case
+    HGVS_Format_json,       // one object per result, without a newline
 };
 
 
@@ -49,143 +54,368 @@ HGVS_is_tty(FILE const* const stream)
 } // HGVS_is_tty
 
 
+// An output collects printed tokens in a growing memory buffer. With a
+// stream it writes whenever HGVS_OUTPUT_BLOCK bytes are pending and on
+// HGVS_output_flush(); without one it only collects. Whether colors are
+// used is decided once, when it is initialized. An output over a
+// caller's buffer never allocates: what does not fit is only counted.
+typedef struct HGVS_Output
+{
+    FILE*            stream;
+    enum HGVS_Format fmt;
+    bool             color;
+    char             system;  // of the description being written
+
+    char*  data;
+    size_t len;
+    size_t size;
+    bool   fixed;  // data is the caller's buffer
+    size_t lost;   // bytes that did not fit in it
+
+    bool error;  // an allocation or write failed; output is lost
+} HGVS_Output;
+
+
+static size_t const HGVS_OUTPUT_BLOCK = 1 << 16;
+
+
+static inline void
+HGVS_output_init(HGVS_Output* const     output,
+                 FILE* const            stream,
+                 enum HGVS_Format const fmt)
+{
+    output->stream = stream;
+    output->fmt = fmt;
+    output->color = fmt == HGVS_Format_console && stream != NULL && HGVS_is_tty(stream);
+    output->system = '\0';
+    output->data = NULL;
+    output->len = 0;
+    output->size = 0;
+    output->fixed = false;
+    output->lost = 0;
+    output->error = false;
+} // HGVS_output_init
+
+
+static inline void
+HGVS_output_init_buffer(HGVS_Output* const     output,
+                        char* const            buf,
+                        size_t const           size,
+                        enum HGVS_Format const fmt)
+{
+    HGVS_output_init(output, NULL, fmt);
+    output->data = buf;
+    output->size = size;
+    output->fixed = true;
+} // HGVS_output_init_buffer
+
+
+// the number of bytes written, including those that did not fit
 static inline size_t
-HGVS_fprintf_operator(FILE*                  stream,
-                      enum HGVS_Format const fmt,
-                      char const             op)
+HGVS_output_length(HGVS_Output const* const output)
 {
-    switch (fmt)
+    return output->len + output->lost;
+} // HGVS_output_length
+
+
+static inline bool
+HGVS_output_flush(HGVS_Output* const output)
+{
+    if (output->stream != NULL && output->len > 0)
     {
-        case HGVS_Format_console:
-            return fprintf(stream, "%s%c%s",
-                           HGVS_is_tty(stream) ? HGVS_ANSI_MAGENTA : "",
-                           op,
-                           HGVS_is_tty(stream) ? HGVS_ANSI_RESET : "");
-        default:
-            break;
-    } // switch
-    return fprintf(stream, "%c", op);
-} // HGVS_fprintf_operator
+        if (fwrite(output->data, 1, output->len, output->stream) != output->len)
+        {
+            output->error = true;
+        } // if
+        output->len = 0;
+    } // if
+    return !output->error;
+} // HGVS_output_flush
+
+
+static inline void
+HGVS_output_destroy(HGVS_Output* const output)
+{
+    if (!output->fixed)
+    {
+        free(output->data);
+    } // if
+    output->data = NULL;
+    output->len = 0;
+    output->size = 0;
+} // HGVS_output_destroy
+
+
+// Room for len more bytes; NULL (and the error flag) on failure. A
+// full caller's buffer is not an error: NULL, and it is up to the
+// writer to fill the rest of it.
+static inline char*
+HGVS_output_reserve(HGVS_Output* const output, size_t const len)
+{
+    if (output->size - output->len >= len)
+    {
+        return output->data + output->len;
+    } // if
+    if (output->fixed)
+    {
+        return NULL;
+    } // if
+    if (output->stream != NULL && output->len + len > HGVS_OUTPUT_BLOCK)
+    {
+        HGVS_output_flush(output);
+        if (output->size >= len)
+        {
+            return output->data;
+        } // if
+    } // if
+
+    size_t size = output->size > 0 ? output->size : 256;
+    while (size - output->len < len)
+    {
+        size *= 2;
+    } // while
+    char* const data = realloc(output->data, size);
+    if (data == NULL)
+    {
+        output->error = true;
+        return NULL;
+    } // if
+    output->data = data;
+    output->size = size;
+    return output->data + output->len;
+} // HGVS_output_reserve
 
 
 static inline size_t
-HGVS_fprintf_keyword(FILE*                  stream,
-                     enum HGVS_Format const fmt,
-                     char const* const      tok)
+HGVS_output_write(HGVS_Output* const output, char const* const ptr, size_t const len)
 {
-    switch (fmt)
+    char* const dst = HGVS_output_reserve(output, len);
+    if (dst == NULL)
     {
-        case HGVS_Format_console:
-            return fprintf(stream, "%s%s%s",
-                           HGVS_is_tty(stream) ? HGVS_ANSI_GREEN : "",
-                           tok,
-                           HGVS_is_tty(stream) ? HGVS_ANSI_RESET : "");
-        default:
-            break;
-    } // switch
-    return fprintf(stream, "%s", tok);
-} // HGVS_fprintf_keyword
+        if (output->fixed)
+        {
+            size_t const room = output->size - output->len;
+            if (room > 0)
+            {
+                memcpy(output->data + output->len, ptr, room);
+            } // if
+            output->len = output->size;
+            output->lost += len - room;
+            return len;
+        } // if
+        return 0;
+    } // if
+    memcpy(dst, ptr, len);
+    output->len += len;
+    return len;
+} // HGVS_output_write
+
+
+static inline size_t
+HGVS_output_puts(HGVS_Output* const output, char const* const str)
+{
+    return HGVS_output_write(output, str, strlen(str));
+} // HGVS_output_puts
 
 
 static inline size_t
-HGVS_fprintf_number(FILE*                  stream,
-                    enum HGVS_Format const fmt,
-                    size_t const           num)
+HGVS_output_putc(HGVS_Output* const output, char const ch)
 {
-    switch (fmt)
+    return HGVS_output_write(output, &ch, 1);
+} // HGVS_output_putc
+
+
+static inline size_t
+HGVS_output_decimal(HGVS_Output* const output, size_t num)
+{
+    char buf[24];
+    char* ptr = buf + sizeof(buf);
+    do
+    {
+        ptr -= 1;
+        *ptr = '0' + num % 10;
+        num /= 10;
+    } while (num > 0); // do
+    return HGVS_output_write(output, ptr, buf + sizeof(buf) - ptr);
+} // HGVS_output_decimal
+
+
+// the color escape or nothing
+static inline size_t
+HGVS_output_color(HGVS_Output* const output, char const* const color)
+{
+    return output->color ? HGVS_output_puts(output, color) : 0;
+} // HGVS_output_color
+
+
+static inline size_t
+HGVS_output_operator(HGVS_Output* const output, char const op)
+{
+    return HGVS_output_color(output, HGVS_ANSI_MAGENTA) +
+           HGVS_output_putc(output, op) +
+           HGVS_output_color(output, HGVS_ANSI_RESET);
+} // HGVS_output_operator
+
+
+static inline size_t
+HGVS_output_keyword(HGVS_Output* const output, char const* const tok)
+{
+    return HGVS_output_color(output, HGVS_ANSI_GREEN) +
+           HGVS_output_puts(output, tok) +
+           HGVS_output_color(output, HGVS_ANSI_RESET);
+} // HGVS_output_keyword
+
+
+static inline size_t
+HGVS_output_number(HGVS_Output* const output, size_t const num)
+{
+    return HGVS_output_color(output, HGVS_ANSI_CYAN) +
+           HGVS_output_decimal(output, num) +
+           HGVS_output_color(output, HGVS_ANSI_RESET);
+} // HGVS_output_number
+
+
+static inline size_t
+HGVS_output_string(HGVS_Output* const output, char const* const ptr, size_t const len)
+{
+    return HGVS_output_color(output, HGVS_ANSI_BOLDWHITE) +
+           HGVS_output_write(output, ptr, len) +
+           HGVS_output_color(output, HGVS_ANSI_RESET);
+} // HGVS_output_string
+
+
+// In HGVS_Format_canonical sequences are written in upper case, and in
+// lower case for RNA (the r. coordinate system).
+static inline size_t
+HGVS_output_sequence(HGVS_Output* const output, char const* const ptr, size_t const len)
+{
+    if (output->fmt != HGVS_Format_canonical)
+    {
+        return HGVS_output_string(output, ptr, len);
+    } // if
+
+    size_t const start = output->len;
+    size_t const res = HGVS_output_write(output, ptr, len);
+    size_t const count = output->fixed ? output->len - start : res;
+    for (size_t i = output->len - count; i < output->len; ++i)
     {
-        case HGVS_Format_console:
-            return fprintf(stream, "%s%zu%s",
-                           HGVS_is_tty(stream) ? HGVS_ANSI_CYAN : "",
-                           num,
-                           HGVS_is_tty(stream) ? HGVS_ANSI_RESET : "");
-        default:
-            break;
-    } // switch
-    return fprintf(stream, "%zu", num);
-} // HGVS_fprintf_number
+        char const ch = output->data[i];
+        output->data[i] = output->system == 'r' ? (ch | 0x20) : (ch & ~0x20);
+    } // for
+    return res;
+} // HGVS_output_sequence
+
+
+static inline size_t
+HGVS_output_char(HGVS_Output* const output, char const ch)
+{
+    return HGVS_output_color(output, HGVS_ANSI_BOLDWHITE) +
+           HGVS_output_putc(output, ch) +
+           HGVS_output_color(output, HGVS_ANSI_RESET);
+} // HGVS_output_char
 
 
 static inline size_t
-HGVS_fprintf_string(FILE*                  stream,
-                    enum HGVS_Format const fmt,
-                    char const* const      ptr,
-                    int const              len)
+HGVS_output_spaces(HGVS_Output* const output, size_t const count)
 {
-    switch (fmt)
+    char* const dst = HGVS_output_reserve(output, count);
+    if (dst == NULL)
     {
-        case HGVS_Format_console:
-            return fprintf(stream, "%s%.*s%s",
-                           HGVS_is_tty(stream) ? HGVS_ANSI_BOLDWHITE : "",
-                           len,
-                           ptr,
-                           HGVS_is_tty(stream) ? HGVS_ANSI_RESET : "");
-        default:
-            break;
-    } // switch
-    return fprintf(stream, "%.*s", len, ptr);
-} // HGVS_fprintf_string
+        if (output->fixed)
+        {
+            size_t const room = output->size - output->len;
+            if (room > 0)
+            {
+                memset(output->data + output->len, ' ', room);
+            } // if
+            output->len = output->size;
+            output->lost += count - room;
+            return count;
+        } // if
+        return 0;
+    } // if
+    memset(dst, ' ', count);
+    output->len += count;
+    return count;
+} // HGVS_output_spaces
 
 
+// A JSON string: quotes, backslashes and all bytes outside printable
+// ASCII are escaped (bytes >= 0x80 as \u0080 to \u00ff), so the output
+// is valid JSON for any input.
 static inline size_t
-HGVS_fprintf_char(FILE*                  stream,
-                  enum HGVS_Format const fmt,
-                  char const             ch)
+HGVS_output_json_string(HGVS_Output* const output, char const* const ptr, size_t const len)
 {
-    switch (fmt)
+    static char const HEX[] = "0123456789abcdef";
+
+    size_t res = HGVS_output_putc(output, '"');
+    size_t run = 0;
+    for (size_t i = 0; i < len; ++i)
     {
-        case HGVS_Format_console:
-            return fprintf(stream, "%s%c%s",
-                           HGVS_is_tty(stream) ? HGVS_ANSI_BOLDWHITE : "",
-                           ch,
-                           HGVS_is_tty(stream) ? HGVS_ANSI_RESET : "");
-        default:
-            break;
-    } // switch
-    return fprintf(stream, "%c", ch);
-} // HGVS_fprintf_char
+        unsigned char const ch = ptr[i];
+        if (ch >= 0x20 && ch < 0x7F && ch != '"' && ch != '\\')
+        {
+            continue;
+        } // if
+        res += HGVS_output_write(output, ptr + run, i - run);
+        run = i + 1;
+        if (ch == '"' || ch == '\\')
+        {
+            char const esc[2] = {'\\', ch};
+            res += HGVS_output_write(output, esc, 2);
+        } // if
+        else
+        {
+            char const esc[6] = {'\\', 'u', '0', '0', HEX[ch >> 4], HEX[ch & 0xF]};
+            res += HGVS_output_write(output, esc, 6);
+        } // else
+    } // for
+    return res + HGVS_output_write(output, ptr + run, len - run) +
+           HGVS_output_putc(output, '"');
+} // HGVS_output_json_string
 
 
+// console: a caret under the offending character and the message on a
+// line of its own; plain: the message right-aligned to the offset
 static inline size_t
-HGVS_fprintf_error(FILE*                  stream,
-                   enum HGVS_Format const fmt,
-                   int const              indent,
-                   char const* const      msg)
+HGVS_output_error(HGVS_Output* const output, size_t const indent, char const* const msg)
 {
-    switch (fmt)
+    if (output->fmt == HGVS_Format_console)
     {
-        case HGVS_Format_console:
-            return fprintf(stream, "%*s%s^ %serror: %s%s%s\n",
-                           indent,
-                           "",
-                           HGVS_is_tty(stream) ? HGVS_ANSI_BOLDGREEN : "",
-                           HGVS_is_tty(stream) ? HGVS_ANSI_BOLDMAGENTA : "",
-                           HGVS_is_tty(stream) ? HGVS_ANSI_BOLDWHITE : "",
-                           msg,
-                           HGVS_is_tty(stream) ? HGVS_ANSI_RESET : "");
-        default:
-            break;
-    } // switch
-    return fprintf(stream, "%*s", indent, msg);
-} // HGVS_fprintf_error
+        return HGVS_output_spaces(output, indent) +
+               HGVS_output_color(output, HGVS_ANSI_BOLDGREEN) +
+               HGVS_output_puts(output, "^ ") +
+               HGVS_output_color(output, HGVS_ANSI_BOLDMAGENTA) +
+               HGVS_output_puts(output, "error: ") +
+               HGVS_output_color(output, HGVS_ANSI_BOLDWHITE) +
+               HGVS_output_puts(output, msg) +
+               HGVS_output_color(output, HGVS_ANSI_RESET) +
+               HGVS_output_putc(output, '\n');
+    } // if
+    size_t const len = strlen(msg);
+    return HGVS_output_spaces(output, indent > len ? indent - len : 0) +
+           HGVS_output_write(output, msg, len);
+} // HGVS_output_error
 
 
 static inline size_t
-HGVS_fprintf_failed(FILE* stream)
+HGVS_output_failed(HGVS_Output* const output)
 {
-    return fprintf(stream, "%sfailed.%s\n",
-                   HGVS_is_tty(stream) ? HGVS_ANSI_BOLDRED : "",
-                   HGVS_is_tty(stream) ? HGVS_ANSI_RESET : "");
-} // HGVS_fprintf_failed
+    return HGVS_output_color(output, HGVS_ANSI_BOLDRED) +
+           HGVS_output_puts(output, "failed.") +
+           HGVS_output_color(output, HGVS_ANSI_RESET) +
+           HGVS_output_putc(output, '\n');
+} // HGVS_output_failed
 
 
 static inline size_t
-HGVS_fprintf_accept(FILE* stream)
+HGVS_output_accept(HGVS_Output* const output)
 {
-    return fprintf(stream, "%saccepted.%s\n",
-                   HGVS_is_tty(stream) ? HGVS_ANSI_BOLDGREEN : "",
-                   HGVS_is_tty(stream) ? HGVS_ANSI_RESET : "");
-} // HGVS_fprintf_accept
+    return HGVS_output_color(output, HGVS_ANSI_BOLDGREEN) +
+           HGVS_output_puts(output, "accepted.") +
+           HGVS_output_color(output, HGVS_ANSI_RESET) +
+           HGVS_output_putc(output, '\n');
+} // HGVS_output_accept
 
 
 #endif
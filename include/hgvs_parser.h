@@ -2,8 +2,284 @@
 #define HGVS_PARSER_H
 
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+
+#include "hgvs_interface.h"
+
+
+enum HGVS_Node_Type
+{
+    HGVS_Node_allocation_error,
+    HGVS_Node_error,
+    HGVS_Node_error_context,
+    HGVS_Node_unknown,
+    HGVS_Node_number,
+    HGVS_Node_sequence,
+    HGVS_Node_identifier,
+    HGVS_Node_reference,
+    HGVS_Node_description,
+    HGVS_Node_offset,
+    HGVS_Node_point,
+    HGVS_Node_uncertain_point,
+    HGVS_Node_range,
+    HGVS_Node_length,
+    HGVS_Node_insert,
+    HGVS_Node_compound_insert,
+    HGVS_Node_substitution,
+    HGVS_Node_repeat,
+    HGVS_Node_compound_repeat,
+    HGVS_Node_deletion,
+    HGVS_Node_deletion_insertion,
+    HGVS_Node_insertion,
+    HGVS_Node_duplication,
+    HGVS_Node_conversion,
+    HGVS_Node_inversion,
+    HGVS_Node_equal,
+    HGVS_Node_slice,
+    HGVS_Node_variant,
+    HGVS_Node_compound_variant,
+};
+
+
+// Why an input was rejected: the innermost error (see HGVS_result_error()
+// and HGVS_error_message()).
+enum HGVS_Error
+{
+    HGVS_Error_none,
+    HGVS_Error_allocation,
+    HGVS_Error_input_too_long,
+    HGVS_Error_unmatched_input,
+    HGVS_Error_number_too_large,
+    HGVS_Error_nesting_too_deep,
+    HGVS_Error_expected_identifier,
+    HGVS_Error_expected_reference,
+    HGVS_Error_expected_coordinate_system,
+    HGVS_Error_expected_allele,
+    HGVS_Error_expected_offset,
+    HGVS_Error_expected_point,
+    HGVS_Error_expected_point_start,
+    HGVS_Error_expected_point_end,
+    HGVS_Error_expected_location,
+    HGVS_Error_expected_unknown_or_number,
+    HGVS_Error_expected_repeat_number,
+    HGVS_Error_expected_substitution_or_repeat_number,
+    HGVS_Error_expected_sequence,
+    HGVS_Error_expected_sequence_or_description,
+    HGVS_Error_expected_length,
+    HGVS_Error_expected_inserted_part,
+    HGVS_Error_expected_colon,
+    HGVS_Error_expected_underscore,
+    HGVS_Error_expected_closing_parenthesis,
+    HGVS_Error_expected_closing_bracket,
+};
+
+
+// values of HGVS_node_data() for offsets, points and inserts
+static size_t const HGVS_NODE_POSITIVE_OFFSET = 1;
+static size_t const HGVS_NODE_NEGATIVE_OFFSET = 2;
+static size_t const HGVS_NODE_DOWNSTREAM      = 1;
+static size_t const HGVS_NODE_UPSTREAM        = 2;
+static size_t const HGVS_NODE_INVERTED        = 1;
+
+
+typedef struct HGVS_Node   HGVS_Node;
+typedef struct HGVS_Result HGVS_Result;
+
+
+// Parses and prints the input, the reprint and the verdict to stdout.
 int
 HGVS_parse(char const* const str);
 
 
+// A result owns the memory of its parse tree and can be reused for any
+// number of parses; each HGVS_result_parse() invalidates the previous
+// tree. The input string is not copied and must outlive the tree.
+HGVS_Result*
+HGVS_result_create(void);
+
+
+void
+HGVS_result_destroy(HGVS_Result* const result);
+
+
+// Whether later parses of a rejected input build the chain of errors:
+// the innermost error and a context for every production it fails
+// (e.g., "while matching a variant"). Off by default: a rejected input
+// then costs no more than an accepted one and only its innermost error
+// is kept, as the only error under the root.
+void
+HGVS_result_trace(HGVS_Result* const result, bool const trace);
+
+
+// Returns 0 if the input is accepted, 1 otherwise. References and
+// descriptions inserted in other descriptions can be nested 64 deep;
+// deeper inputs are rejected (HGVS_Error_nesting_too_deep).
+int
+HGVS_result_parse(HGVS_Result* const result, char const* const str);
+
+
+// As HGVS_result_parse() for exactly len characters at str, which need
+// not be NUL-terminated, e.g., a field inside a larger buffer. Inputs of
+// 4 GiB or more are rejected.
+int
+HGVS_result_parse_n(HGVS_Result* const result, char const* const str, size_t const len);
+
+
+// As HGVS_result_parse_n(), but the input is only recognized: the same
+// grammar is matched without building a tree, so HGVS_result_root() is
+// NULL and a rejected input has its innermost error only. Written, an
+// accepted input is copied as it is.
+int
+HGVS_result_recognize_n(HGVS_Result* const result, char const* const str, size_t const len);
+
+
+bool
+HGVS_result_accepted(HGVS_Result const* const result);
+
+
+// Copies the parse tree into buf, like snprintf(): only if it fits in
+// size bytes, and returns its size in either case. A frozen tree refers
+// to the input by offsets only, so it can be kept without the result
+// and thawed later for the same input instead of parsing it again. It
+// is valid for the same build of the parser only. Error messages are
+// addresses and are not trusted: thawing restores the innermost one
+// from its code, and a tree with a trace of errors (see
+// HGVS_result_trace()) cannot be thawed.
+size_t
+HGVS_result_freeze(HGVS_Result const* const result, void* const buf, size_t const size);
+
+
+// Restores a tree frozen for the input str of len characters. Returns
+// as HGVS_result_parse_n(), or -1 if the frozen tree does not fit the
+// input, is not a tree (a node refers to itself or to an ancestor), has
+// a trace of errors or memory runs out; the result is empty then.
+int
+HGVS_result_thaw(HGVS_Result* const result,
+                 char const* const  str,
+                 size_t const       len,
+                 void const* const  buf,
+                 size_t const       size);
+
+
+char const*
+HGVS_result_input(HGVS_Result const* const result);
+
+
+size_t
+HGVS_result_input_length(HGVS_Result const* const result);
+
+
+// The root of the tree; for rejected inputs this is the outermost
+// HGVS_Node_error (or HGVS_Node_allocation_error), see
+// HGVS_result_trace().
+HGVS_Node const*
+HGVS_result_root(HGVS_Result const* const result);
+
+
+// Where and why a rejected input failed: the innermost error of the
+// chain under the root. The message is NULL for accepted inputs.
+enum HGVS_Error
+HGVS_result_error(HGVS_Result const* const result);
+
+
+size_t
+HGVS_result_error_offset(HGVS_Result const* const result);
+
+
+char const*
+HGVS_result_error_message(HGVS_Result const* const result);
+
+
+// The message of an error code; NULL for HGVS_Error_none.
+char const*
+HGVS_error_message(enum HGVS_Error const error);
+
+
+// Reprints the parse tree: colored in HGVS_Format_console when the
+// stream is a terminal. The output is built in memory and written at
+// once; see HGVS_result_write() to collect several results in one
+// HGVS_Output.
+size_t
+HGVS_result_print(FILE*                     stream,
+                  enum HGVS_Format const    fmt,
+                  HGVS_Result const* const  result);
+
+
+// Appends the reprint to an output (see hgvs_interface.h), which is
+// written when it is full or flushed.
+size_t
+HGVS_result_write(HGVS_Output* const output, HGVS_Result const* const result);
+
+
+// Writes the canonical form of an accepted description into buf, like
+// snprintf(): at most size - 1 bytes and a NUL, and returns the length
+// of the whole form, so a call with size 0 (buf may be NULL) measures
+// it. Numbers lose their leading zeros, sequences are in upper case (in
+// lower case for r.) and coordinate systems in lower case; identifiers
+// are kept as they are. Parsing the canonical form gives it back.
+// Neither allocates nor uses stdio; returns 0 for a rejected (or only
+// recognized) input.
+size_t
+HGVS_result_canonical(HGVS_Result const* const result, char* const buf, size_t const size);
+
+
+// Writes the counters of a parser built with OPTIONS=STATS: the number
+// of parses, nodes created and handed back, failed alternatives, errors
+// and error frames, the calls per production and the calls and bytes
+// consumed per lexer function, each in total and per parse, one
+// tab-separated line per counter. They add up over all parses with this
+// result. Writes nothing otherwise. Returns the number of characters
+// written, or -1 on a write error (as fprintf()).
+int
+HGVS_result_print_stats(FILE* stream, HGVS_Result const* const result);
+
+
+// Adds the counters of another result to those of this one, e.g. of the
+// results of several threads. Does nothing without OPTIONS=STATS.
+void
+HGVS_result_add_stats(HGVS_Result* const result, HGVS_Result const* const other);
+
+
+enum HGVS_Node_Type
+HGVS_node_type(HGVS_Result const* const result, HGVS_Node const* const node);
+
+
+// The children of a node; NULL for a compound (see HGVS_node_item()).
+HGVS_Node const*
+HGVS_node_left(HGVS_Result const* const result, HGVS_Node const* const node);
+
+
+HGVS_Node const*
+HGVS_node_right(HGVS_Result const* const result, HGVS_Node const* const node);
+
+
+// The elements of compound inserts, repeats and variants, by index in
+// constant time; HGVS_node_data() is their number. NULL past the last
+// element and for any other node.
+HGVS_Node const*
+HGVS_node_item(HGVS_Result const* const result, HGVS_Node const* const node, size_t const index);
+
+
+// Numbers, lengths of sequences and identifiers, coordinate systems,
+// element counts, the HGVS_NODE_* flags above and the HGVS_Error of an
+// innermost error.
+size_t
+HGVS_node_data(HGVS_Result const* const result, HGVS_Node const* const node);
+
+
+// The position in the input where the node starts; for errors the
+// position of the failure. Not meaningful for error contexts.
+size_t
+HGVS_node_offset(HGVS_Result const* const result, HGVS_Node const* const node);
+
+
+// The start of the matched text (sequences and identifiers are data()
+// characters long), or the message of an error context.
+char const*
+HGVS_node_ptr(HGVS_Result const* const result, HGVS_Node const* const node);
+
+
 #endif
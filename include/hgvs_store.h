@@ -0,0 +1,60 @@
+#ifndef HGVS_STORE_H
+#define HGVS_STORE_H
+
+
+#include <stdbool.h>
+#include <stddef.h>
+
+
+#include "hgvs_cache.h"
+#include "hgvs_parser.h"
+
+
+// A file of verdicts (and frozen trees of accepted inputs) that outlives
+// the process, so a run over (mostly) the same inputs as an earlier run
+// parses only the new ones. The file is memory mapped and records are
+// only ever appended to it, in blocks. Every record carries a checksum:
+// a record that was partly written when a process died ends the valid
+// part of the file and is overwritten by the next append.
+//
+// Any number of processes can use the same file at once: each indexes
+// the records present when it opens the file and adds new records under
+// a file lock. Within a process the store can be shared by any number
+// of threads, each with its own result.
+typedef struct HGVS_Store HGVS_Store;
+
+
+// Opens the store at path, creating it if it does not exist. A file
+// that cannot be written is used read-only. With trees a hit gives a
+// result as if the input was parsed (see HGVS_cache_create()); verdicts
+// stored without one get their tree added. NULL on failure, or if the
+// file is not a store of this version of the parser.
+HGVS_Store*
+HGVS_store_open(char const* const path, bool const trees);
+
+
+// Closes the store; the records added are written and synced to disk.
+void
+HGVS_store_close(HGVS_Store* const store);
+
+
+// As HGVS_cache_parse_n(). The trees of rejected inputs are not stored
+// (their messages are addresses in this process), so with trees these
+// inputs are parsed always. New verdicts are appended to the file.
+int
+HGVS_store_parse_n(HGVS_Store* const   store,
+                   HGVS_Result* const  result,
+                   char const* const   str,
+                   size_t const        len,
+                   HGVS_Verdict* const verdict);
+
+
+size_t
+HGVS_store_hits(HGVS_Store* const store);
+
+
+size_t
+HGVS_store_misses(HGVS_Store* const store);
+
+
+#endif
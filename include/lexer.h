@@ -11,82 +11,195 @@ WARNING: this file is *not* to be included directly as it pollutes the
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 
-static size_t const MAX_NUMBER     = SIZE_MAX / 10 - 10;
-static size_t const INVALID_NUMBER = -1;
+#include "scan.h"
 
 
-static inline size_t
-to_integer(char const ch)
+// digits are parsed 8 at a time as one 64-bit word on little-endian
+// GNU targets, one at a time elsewhere
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define LEXER_SWAR
+#endif
+
+
+enum Number_Match
 {
-    if (ch == '1') return 1;
-    if (ch == '2') return 2;
-    if (ch == '3') return 3;
-    if (ch == '4') return 4;
-    if (ch == '5') return 5;
-    if (ch == '6') return 6;
-    if (ch == '7') return 7;
-    if (ch == '8') return 8;
-    if (ch == '9') return 9;
-    return 0;
-} // to_integer
+    NUMBER_UNMATCHED = 0,
+    NUMBER_MATCHED,
+    NUMBER_OVERFLOW,  // all digits are consumed, the value is not kept
+};
+
+
+enum
+{
+    CLASS_DIGIT      = 1 << 0,
+    CLASS_ALPHA      = 1 << 1,
+    CLASS_IUPAC_NT   = 1 << 2,
+    CLASS_IDENTIFIER = 1 << 3,  // alphanumeric, '.' and '_'
+};
+
+
+// character classes indexed by (unsigned char); zero for anything else
+static uint8_t const CHAR_CLASS[256] = {
+    ['0'] = CLASS_DIGIT | CLASS_IDENTIFIER,
+    ['1'] = CLASS_DIGIT | CLASS_IDENTIFIER,
+    ['2'] = CLASS_DIGIT | CLASS_IDENTIFIER,
+    ['3'] = CLASS_DIGIT | CLASS_IDENTIFIER,
+    ['4'] = CLASS_DIGIT | CLASS_IDENTIFIER,
+    ['5'] = CLASS_DIGIT | CLASS_IDENTIFIER,
+    ['6'] = CLASS_DIGIT | CLASS_IDENTIFIER,
+    ['7'] = CLASS_DIGIT | CLASS_IDENTIFIER,
+    ['8'] = CLASS_DIGIT | CLASS_IDENTIFIER,
+    ['9'] = CLASS_DIGIT | CLASS_IDENTIFIER,
+    ['A'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['a'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['B'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['b'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['C'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['c'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['D'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['d'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['E'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['e'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['F'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['f'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['G'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['g'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['H'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['h'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['I'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['i'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['J'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['j'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['K'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['k'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['L'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['l'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['M'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['m'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['N'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['n'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['O'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['o'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['P'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['p'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['Q'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['q'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['R'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['r'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['S'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['s'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['T'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['t'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['U'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['u'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['V'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['v'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['W'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['w'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['X'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['x'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['Y'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['y'] = CLASS_ALPHA | CLASS_IUPAC_NT | CLASS_IDENTIFIER,
+    ['Z'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['z'] = CLASS_ALPHA | CLASS_IDENTIFIER,
+    ['.'] = CLASS_IDENTIFIER,
+    ['_'] = CLASS_IDENTIFIER,
+}; // CHAR_CLASS
+
+
+static inline bool
+has_class(char const ch, uint8_t const cls)
+{
+    return (CHAR_CLASS[(unsigned char) ch] & cls) != 0;
+} // has_class
 
 
 static inline bool
 is_decimal_digit(char const ch)
 {
-    return ch == '0' || ch == '1' || ch == '2' || ch == '3' ||
-           ch == '4' || ch == '5' || ch == '6' || ch == '7' ||
-           ch == '8' || ch == '9';
+    return has_class(ch, CLASS_DIGIT);
 } // is decimal_digit
 
 
+static inline size_t
+to_integer(char const ch)
+{
+    return is_decimal_digit(ch) ? (size_t) (ch - '0') : 0;
+} // to_integer
+
+
 static inline bool
 is_IUPAC_NT(char const ch)
 {
-    return ch == 'A' || ch == 'C' || ch == 'G' || ch == 'T' ||
-           ch == 'R' || ch == 'Y' || ch == 'S' || ch == 'W' ||
-           ch == 'K' || ch == 'M' || ch == 'B' || ch == 'D' ||
-           ch == 'H' || ch == 'V' || ch == 'N' || ch == 'U' ||
-           ch == 'a' || ch == 'c' || ch == 'g' || ch == 't' ||
-           ch == 'r' || ch == 'y' || ch == 's' || ch == 'w' ||
-           ch == 'k' || ch == 'm' || ch == 'b' || ch == 'd' ||
-           ch == 'h' || ch == 'v' || ch == 'n' || ch == 'u';
+    return has_class(ch, CLASS_IUPAC_NT);
 } // is_IUPAC_NT
 
 
 static inline bool
 is_alpha(const char ch)
 {
-    return ch == 'A' || ch == 'B' || ch == 'C' || ch == 'D' ||
-           ch == 'E' || ch == 'F' || ch == 'G' || ch == 'H' ||
-           ch == 'I' || ch == 'J' || ch == 'K' || ch == 'L' ||
-           ch == 'M' || ch == 'N' || ch == 'O' || ch == 'P' ||
-           ch == 'Q' || ch == 'R' || ch == 'S' || ch == 'T' ||
-           ch == 'U' || ch == 'V' || ch == 'W' || ch == 'X' ||
-           ch == 'Y' || ch == 'Z' ||
-           ch == 'a' || ch == 'b' || ch == 'c' || ch == 'd' ||
-           ch == 'e' || ch == 'f' || ch == 'g' || ch == 'h' ||
-           ch == 'i' || ch == 'j' || ch == 'k' || ch == 'l' ||
-           ch == 'm' || ch == 'n' || ch == 'o' || ch == 'p' ||
-           ch == 'q' || ch == 'r' || ch == 's' || ch == 't' ||
-           ch == 'u' || ch == 'v' || ch == 'w' || ch == 'x' ||
-           ch == 'y' || ch == 'z';
+    return has_class(ch, CLASS_ALPHA);
 } // is_alpha
 
 
 static inline bool
 is_alphanumeric(const char ch)
 {
-    return is_alpha(ch) || is_decimal_digit(ch);
+    return has_class(ch, CLASS_DIGIT | CLASS_ALPHA);
 } // is_alphanumeric
 
 
 static inline bool
-match_alpha(char const** const ptr, size_t* ch)
+is_identifier(char const ch)
+{
+    return has_class(ch, CLASS_IDENTIFIER);
+} // is_identifier
+
+
+// most runs are short: only runs longer than this are handed to the
+// vector kernels in scan.h
+static size_t const SCAN_INLINE = 16;
+
+
+static inline char const*
+skip_IUPAC_NT(char const* ptr, char const* const end)
+{
+    char const* const stop = (size_t) (end - ptr) > SCAN_INLINE ? ptr + SCAN_INLINE : end;
+    while (ptr < stop && is_IUPAC_NT(*ptr))
+    {
+        ptr += 1;
+    } // while
+    if (ptr == stop && ptr < end)
+    {
+        return scan_IUPAC_NT(ptr, end);
+    } // if
+    return ptr;
+} // skip_IUPAC_NT
+
+
+static inline char const*
+skip_identifier(char const* ptr, char const* const end)
+{
+    char const* const stop = (size_t) (end - ptr) > SCAN_INLINE ? ptr + SCAN_INLINE : end;
+    while (ptr < stop && is_identifier(*ptr))
+    {
+        ptr += 1;
+    } // while
+    if (ptr == stop && ptr < end)
+    {
+        return scan_identifier(ptr, end);
+    } // if
+    return ptr;
+} // skip_identifier
+
+
+static inline bool
+match_alpha(char const** const ptr, char const* const end, size_t* ch)
 {
-    if (is_alpha(**ptr))
+    if (*ptr < end && is_alpha(**ptr))
     {
         *ch = **ptr;
         *ptr += 1;
@@ -97,9 +210,9 @@ match_alpha(char const** const ptr, size_t* ch)
 
 
 static inline bool
-match_char(char const** const ptr, char const ch)
+match_char(char const** const ptr, char const* const end, char const ch)
 {
-    if (**ptr == ch)
+    if (*ptr < end && **ptr == ch)
     {
         *ptr += 1;
         return true;
@@ -108,66 +221,131 @@ match_char(char const** const ptr, char const ch)
 } // match_char
 
 
-static inline bool
-match_number(char const** const ptr, size_t* num)
+#if defined(LEXER_SWAR)
+
+
+static uint64_t const SWAR_ZEROS = 0x3030303030303030;
+static uint64_t const SWAR_HIGH  = 0x8080808080808080;
+
+
+// the first (up to) 8 characters as the bytes of a word, least
+// significant first; missing bytes are zero, which is not a digit
+static inline uint64_t
+swar_load(char const* const ptr, char const* const end)
+{
+    uint64_t word = 0;
+    if (end - ptr >= 8)
+    {
+        memcpy(&word, ptr, 8);
+    } // if
+    else
+    {
+        memcpy(&word, ptr, end - ptr);
+    } // else
+    return word;
+} // swar_load
+
+
+// value of 8 digits (0 -- 9 per byte, most significant first)
+static inline uint64_t
+swar_value(uint64_t digits)
 {
+    digits = digits * 10 + (digits >> 8);
+    return (((digits & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+            (((digits >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+} // swar_value
+
+
+#endif
+
+
+static inline enum Number_Match
+match_number(char const** const ptr, char const* const end, size_t* num)
+{
+    char const* tmp = *ptr;
+    bool overflow = false;
     *num = 0;
-    bool matched = false;
-    while (is_decimal_digit(**ptr))
+
+#if defined(LEXER_SWAR)
+    static uint64_t const POWER[9] =
     {
-        matched = true;
-        if (*num < MAX_NUMBER)
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+    };
+
+    for (;;)
+    {
+        // bytes become 0 -- 9 for digits; with 0x76 added these are the
+        // only ones that keep the high bit clear (carries only run into
+        // bytes after a non-digit)
+        uint64_t const digits = swar_load(tmp, end) ^ SWAR_ZEROS;
+        uint64_t const mask = ((digits + 0x7676767676767676) | digits) & SWAR_HIGH;
+        unsigned const count = mask == 0 ? 8 : __builtin_ctzll(mask) / 8;
+        if (count == 0)
         {
-            *num *= 10;
-            *num += to_integer(**ptr);
+            break;
         } // if
-        else
+
+        // shift out the non-digits; the bytes shifted in are leading zeros
+        uint64_t const value = swar_value(count == 8 ? digits : digits << (64 - 8 * count));
+        overflow |= __builtin_mul_overflow(*num, POWER[count], num);
+        overflow |= __builtin_add_overflow(*num, value, num);
+        tmp += count;
+        if (count < 8)
         {
-            *num = INVALID_NUMBER;
-        } // else
-        *ptr += 1;
+            break;
+        } // if
+    } // for
+#else
+    while (tmp < end && is_decimal_digit(*tmp))
+    {
+        size_t const digit = to_integer(*tmp);
+        if (*num > (SIZE_MAX - digit) / 10)
+        {
+            overflow = true;
+        } // if
+        *num = *num * 10 + digit;
+        tmp += 1;
     } // while
-    return matched;
+#endif
+
+    if (tmp == *ptr)
+    {
+        return NUMBER_UNMATCHED;
+    } // if
+    *ptr = tmp;
+    return overflow ? NUMBER_OVERFLOW : NUMBER_MATCHED;
 } // match_number
 
 
 static inline bool
-match_sequence(char const** const ptr, size_t* len)
+match_sequence(char const** const ptr, char const* const end, size_t* len)
 {
-    *len = 0;
-    bool matched = false;
-    while (is_IUPAC_NT(**ptr))
-    {
-        matched = true;
-        *ptr += 1;
-        *len += 1;
-    } // while
-    return matched;
+    char const* const tmp = skip_IUPAC_NT(*ptr, end);
+    *len = tmp - *ptr;
+    *ptr = tmp;
+    return *len > 0;
 } // match_sequence
 
 
 static inline bool
-match_identifier(char const** const ptr, size_t* len)
+match_identifier(char const** const ptr, char const* const end, size_t* len)
 {
     *len = 0;
-    bool matched = false;
-    if (is_alpha(**ptr))
+    if (*ptr < end && is_alpha(**ptr))
     {
-        matched = true;
-        while (is_alphanumeric(**ptr) || **ptr == '.' || **ptr == '_')
-        {
-            *ptr += 1;
-            *len += 1;
-        } // while
+        char const* const tmp = skip_identifier(*ptr + 1, end);
+        *len = tmp - *ptr;
+        *ptr = tmp;
+        return true;
     } // if
-    return matched;
+    return false;
 } // match_identifier
 
 
 static inline bool
-match_string(char const** const ptr, char const* str)
+match_string(char const** const ptr, char const* const end, char const* str)
 {
-    while (*str != '\0' && *str == **ptr)
+    while (*str != '\0' && *ptr < end && *str == **ptr)
     {
         str += 1;
         *ptr += 1;
@@ -176,4 +354,12 @@ match_string(char const** const ptr, char const* str)
 } // match_string
 
 
+// as match_string() without consuming any input
+static inline bool
+peek_string(char const* ptr, char const* const end, char const* str)
+{
+    return match_string(&ptr, end, str);
+} // peek_string
+
+
 #endif
@@ -0,0 +1,22 @@
+#ifndef HGVS_SCAN_H
+#define HGVS_SCAN_H
+
+
+/*
+WARNING: this file is *not* to be included directly as it pollutes the
+         global namespace
+*/
+
+
+// Return the first character in [ptr, end) that is not an IUPAC
+// nucleotide (or identifier character), or end. Long runs are scanned
+// 16 or 32 bytes at a time when the CPU supports SSE2 or AVX2.
+char const*
+scan_IUPAC_NT(char const* ptr, char const* const end);
+
+
+char const*
+scan_identifier(char const* ptr, char const* const end);
+
+
+#endif
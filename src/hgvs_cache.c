@@ -0,0 +1,310 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#include "../include/hash.h"
+#include "../include/hgvs_cache.h"
+#include "../include/hgvs_parser.h"
+
+
+static size_t const   SHARDS = 64;  // a power of two
+static size_t const   LIMIT  = UINT32_MAX;  // of inputs, trees and entries per shard
+
+
+// A slot of a shard's table; a hash of 0 marks an empty one.
+typedef struct Entry
+{
+    uint64_t hash;
+    char*    data;  // the input, followed by its frozen tree
+    uint32_t len;   // of the input
+    uint32_t size;  // of the frozen tree
+
+    bool used;  // since the clock hand last passed
+
+    bool        accepted;
+    uint32_t    error_offset;
+    char const* error_message;
+} Entry;
+
+
+// Entries live in an open addressing table (linear probing) that is at
+// most half full. Eviction approximates LRU by the CLOCK algorithm: a
+// hit only sets the entry's used flag, so it touches no other entries.
+typedef struct Shard
+{
+    pthread_mutex_t lock;
+
+    Entry* slots;
+    size_t mask;  // the number of slots - 1
+    size_t count;
+    size_t capacity;
+    size_t hand;
+
+    size_t hits;
+    size_t misses;
+} Shard;
+
+
+struct HGVS_Cache
+{
+    bool  trees;
+    Shard shards[];
+};
+
+
+// the slot of the input or the empty slot where it belongs
+static size_t
+find(Shard const* const shard, uint64_t const key, char const* const str, size_t const len)
+{
+    size_t index = key & shard->mask;
+    while (shard->slots[index].hash != 0)
+    {
+        Entry const* const entry = &shard->slots[index];
+        if (entry->hash == key && entry->len == len && memcmp(entry->data, str, len) == 0)
+        {
+            break;
+        } // if
+        index = (index + 1) & shard->mask;
+    } // while
+    return index;
+} // find
+
+
+// Frees the first entry the clock hand finds unused, moving later
+// entries of its probe sequence back into the hole.
+static void
+evict(Shard* const shard)
+{
+    size_t hole = 0;
+    for (;;)
+    {
+        Entry* const entry = &shard->slots[shard->hand];
+        hole = shard->hand;
+        shard->hand = (shard->hand + 1) & shard->mask;
+        if (entry->hash != 0)
+        {
+            if (!entry->used)
+            {
+                break;
+            } // if
+            entry->used = false;
+        } // if
+    } // for
+    free(shard->slots[hole].data);
+    shard->count -= 1;
+
+    size_t index = hole;
+    for (;;)
+    {
+        index = (index + 1) & shard->mask;
+        Entry const* const entry = &shard->slots[index];
+        if (entry->hash == 0)
+        {
+            break;
+        } // if
+        // distances from the slot the entry belongs in
+        size_t const home = entry->hash & shard->mask;
+        if (((index - home) & shard->mask) >= ((index - hole) & shard->mask))
+        {
+            shard->slots[hole] = *entry;
+            hole = index;
+        } // if
+    } // for
+    shard->slots[hole].hash = 0;
+    shard->slots[hole].data = NULL;
+} // evict
+
+
+static void
+verdict_of(HGVS_Result const* const result, HGVS_Verdict* const verdict)
+{
+    verdict->accepted = HGVS_result_accepted(result);
+    verdict->tree = HGVS_result_root(result) != NULL;
+    verdict->error_offset = HGVS_result_error_offset(result);
+    verdict->error_message = HGVS_result_error_message(result);
+} // verdict_of
+
+
+HGVS_Cache*
+HGVS_cache_create(size_t const entries, bool const trees)
+{
+    if (entries == 0 || entries / SHARDS >= LIMIT)
+    {
+        return NULL;
+    } // if
+
+    HGVS_Cache* const cache = calloc(1, sizeof(*cache) + SHARDS * sizeof(cache->shards[0]));
+    if (cache == NULL)
+    {
+        return NULL;
+    } // if
+    cache->trees = trees;
+
+    size_t const capacity = (entries + SHARDS - 1) / SHARDS;
+    size_t slots = 2;
+    while (slots < 2 * capacity)
+    {
+        slots *= 2;
+    } // while
+
+    for (size_t i = 0; i < SHARDS; ++i)
+    {
+        Shard* const shard = &cache->shards[i];
+        shard->slots = calloc(slots, sizeof(*shard->slots));
+        if (shard->slots == NULL)
+        {
+            HGVS_cache_destroy(cache);
+            return NULL;
+        } // if
+        pthread_mutex_init(&shard->lock, NULL);
+        shard->mask = slots - 1;
+        shard->capacity = capacity;
+    } // for
+    return cache;
+} // HGVS_cache_create
+
+
+void
+HGVS_cache_destroy(HGVS_Cache* const cache)
+{
+    if (cache == NULL)
+    {
+        return;
+    } // if
+    for (size_t i = 0; i < SHARDS; ++i)
+    {
+        Shard* const shard = &cache->shards[i];
+        if (shard->slots == NULL)
+        {
+            break;
+        } // if
+        for (size_t j = 0; j <= shard->mask; ++j)
+        {
+            free(shard->slots[j].data);
+        } // for
+        free(shard->slots);
+        pthread_mutex_destroy(&shard->lock);
+    } // for
+    free(cache);
+} // HGVS_cache_destroy
+
+
+int
+HGVS_cache_parse_n(HGVS_Cache* const   cache,
+                   HGVS_Result* const  result,
+                   char const* const   str,
+                   size_t const        len,
+                   HGVS_Verdict* const verdict)
+{
+    if (len >= LIMIT)
+    {
+        int const ret = HGVS_result_parse_n(result, str, len);
+        verdict_of(result, verdict);
+        return ret;
+    } // if
+
+    uint64_t const key = hash(str, len);
+    Shard* const shard = &cache->shards[(key >> 32) & (SHARDS - 1)];
+
+    pthread_mutex_lock(&shard->lock);
+    Entry* const entry = &shard->slots[find(shard, key, str, len)];
+    if (entry->hash != 0)
+    {
+        entry->used = true;
+        verdict->accepted = entry->accepted;
+        verdict->tree = cache->trees &&
+                        HGVS_result_thaw(result, str, len, entry->data + len, entry->size) >= 0;
+        verdict->error_offset = entry->error_offset;
+        verdict->error_message = entry->error_message;
+        if (verdict->tree || !cache->trees)
+        {
+            shard->hits += 1;
+            pthread_mutex_unlock(&shard->lock);
+            return verdict->accepted ? 0 : 1;
+        } // if
+    } // if
+    shard->misses += 1;
+    pthread_mutex_unlock(&shard->lock);
+
+    int const ret = cache->trees ? HGVS_result_parse_n(result, str, len)
+                                 : HGVS_result_recognize_n(result, str, len);
+    verdict_of(result, verdict);
+    HGVS_Node const* const root = HGVS_result_root(result);
+    if (root != NULL && HGVS_node_type(result, root) == HGVS_Node_allocation_error)
+    {
+        return ret;
+    } // if
+
+    // the copy is made outside the lock; another thread may have
+    // added the same input in the mean time
+    size_t const size = cache->trees ? HGVS_result_freeze(result, NULL, 0) : 0;
+    if (size >= LIMIT - len)
+    {
+        return ret;
+    } // if
+    char* const data = malloc(len + size);
+    if (data == NULL)
+    {
+        return ret;
+    } // if
+    memcpy(data, str, len);
+    HGVS_result_freeze(result, data + len, size);
+
+    pthread_mutex_lock(&shard->lock);
+    if (shard->slots[find(shard, key, str, len)].hash != 0)
+    {
+        pthread_mutex_unlock(&shard->lock);
+        free(data);
+        return ret;
+    } // if
+    if (shard->count == shard->capacity)
+    {
+        evict(shard);
+    } // if
+
+    Entry* const slot = &shard->slots[find(shard, key, str, len)];
+    slot->hash = key;
+    slot->data = data;
+    slot->len = len;
+    slot->size = size;
+    slot->used = false;
+    slot->accepted = verdict->accepted;
+    slot->error_offset = verdict->error_offset;
+    slot->error_message = verdict->error_message;
+    shard->count += 1;
+    pthread_mutex_unlock(&shard->lock);
+
+    return ret;
+} // HGVS_cache_parse_n
+
+
+size_t
+HGVS_cache_hits(HGVS_Cache* const cache)
+{
+    size_t res = 0;
+    for (size_t i = 0; i < SHARDS; ++i)
+    {
+        pthread_mutex_lock(&cache->shards[i].lock);
+        res += cache->shards[i].hits;
+        pthread_mutex_unlock(&cache->shards[i].lock);
+    } // for
+    return res;
+} // HGVS_cache_hits
+
+
+size_t
+HGVS_cache_misses(HGVS_Cache* const cache)
+{
+    size_t res = 0;
+    for (size_t i = 0; i < SHARDS; ++i)
+    {
+        pthread_mutex_lock(&cache->shards[i].lock);
+        res += cache->shards[i].misses;
+        pthread_mutex_unlock(&cache->shards[i].lock);
+    } // for
+    return res;
+} // HGVS_cache_misses
@@ -1,7 +1,9 @@
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 
 #include "../include/hgvs_parser.h"
@@ -9,529 +11,1118 @@
 #include "../include/lexer.h"
 
 
-static size_t const NODE_POSITIVE_OFFSET = 1;
-static size_t const NODE_NEGATIVE_OFFSET = 2;
-static size_t const NODE_DOWNSTREAM      = 1;
-static size_t const NODE_UPSTREAM        = 2;
-static size_t const NODE_INVERTED        = 1;
-
-
-typedef struct Node
-{
-    enum Node_Type
-    {
-        NODE_ALLOCATION_ERROR,
-        NODE_ERROR,
-        NODE_ERROR_CONTEXT,
-        NODE_UNKNOWN,
-        NODE_NUMBER,
-        NODE_SEQUENCE,
-        NODE_IDENTIFIER,
-        NODE_REFERENCE,
-        NODE_DESCRIPTION,
-        NODE_OFFSET,
-        NODE_POINT,
-        NODE_UNCERTAIN_POINT,
-        NODE_RANGE,
-        NODE_LENGTH,
-        NODE_INSERT,
-        NODE_COMPOUND_INSERT,
-        NODE_SUBSTITUTION,
-        NODE_REPEAT,
-        NODE_COMPOUND_REPEAT,
-        NODE_DELETION,
-        NODE_DELETION_INSERTION,
-        NODE_INSERTION,
-        NODE_DUPLICATION,
-        NODE_CONVERSION,
-        NODE_INVERSION,
-        NODE_EQUAL,
-        NODE_SLICE,
-        NODE_VARIANT,
-        NODE_COMPOUND_VARIANT,
-    } Node_Type;
-
-    struct Node* left;
-    struct Node* right;
-
-    char const* ptr;
-    size_t      data;
-
-    enum Node_Type type;
+// Nodes live in one contiguous array per parser and refer to each other
+// (and to the input) by 32-bit indices and offsets, so a node is 20
+// bytes instead of 40 and a tree can be moved or copied as a whole.
+typedef uint32_t Index;
+
+
+static Index const NONE             = 0;  // no node (a NULL child)
+static Index const ALLOCATION_ERROR = 1;  // the only node of a failed allocation
+
+// A recognizer (see HGVS_result_recognize_n()) stores no nodes: it runs
+// the same productions, but an index then is the offset of its node in
+// the input with the top bit set and every write to a node goes to the
+// scratch node.
+static Index const VIRTUAL          = UINT32_C(1) << 31;
+static Index const SCRATCH          = 2;
+
+// Without a trace (see HGVS_result_trace()) an error is only recorded,
+// in these two nodes: the innermost error and its message.
+static Index const ERROR            = 3;
+static Index const ERROR_CONTEXT    = 4;
+
+static Index const FIRST            = 5;  // the first node of a tree
+
+
+static size_t const NODES_INITIAL   = 256;
+static size_t const PENDING_INITIAL = 64;
+
+
+// References and inserted descriptions nest at most NESTING_LIMIT deep:
+// this bounds the recursion of the parser and the depth of a tree, and
+// so the stack of print() and json() (see Task), which has at most ten
+// or so tasks pending per level.
+enum
+{
+    NESTING_LIMIT = 64,
+    TASKS_LIMIT   = 16 * (NESTING_LIMIT + 1)
+};
+
+
+typedef struct HGVS_Node
+{
+    Index left;
+    Index right;
+
+    uint32_t offset;  // into the input
+    uint32_t data;
+
+    uint8_t type;  // enum HGVS_Node_Type
 } Node;
 
 
-static Node ALLOCATION_ERROR = {
-    .left  = NULL,
-    .right = NULL,
-    .data  = 0,
-    .ptr   = "allocation error; out of memory?",
-    .type  = NODE_ALLOCATION_ERROR
-}; // ALLOCATION_ERROR
+// Compound inserts, repeats and variants keep their elements in item
+// nodes that follow each other, ITEMS_PER_NODE indices in each (in left,
+// right, offset and data): a compound's left is its first item node and
+// its data the number of elements. Item nodes are not part of the tree
+// as seen through the API.
+static uint8_t const ITEMS          = HGVS_Node_compound_variant + 1;
+static size_t const  ITEMS_PER_NODE = 4;
+
+
+static char const* const ALLOCATION_ERROR_MESSAGE = "allocation error; out of memory?";
+
+
+static char const* const ERROR_MESSAGES[] =
+{
+    [HGVS_Error_none]                                   = NULL,
+    [HGVS_Error_allocation]                             = "allocation error; out of memory?",
+    [HGVS_Error_input_too_long]                         = "input too long",
+    [HGVS_Error_unmatched_input]                        = "unmatched input",
+    [HGVS_Error_number_too_large]                       = "number too large",
+    [HGVS_Error_nesting_too_deep]                       = "nesting too deep",
+    [HGVS_Error_expected_identifier]                    = "expected an identifier",
+    [HGVS_Error_expected_reference]                     = "expected a reference",
+    [HGVS_Error_expected_coordinate_system]             = "expected a coordinate system",
+    [HGVS_Error_expected_allele]                        = "expected an allele",
+    [HGVS_Error_expected_offset]                        = "expected an offset",
+    [HGVS_Error_expected_point]                         = "expected a point (exact or uncertain)",
+    [HGVS_Error_expected_point_start]                   = "expected an exact point (start)",
+    [HGVS_Error_expected_point_end]                     = "expected an exact point (end)",
+    [HGVS_Error_expected_location]                      = "expected a location",
+    [HGVS_Error_expected_unknown_or_number]             = "expected an unknown or number",
+    [HGVS_Error_expected_repeat_number]                 = "expected a repeat number",
+    [HGVS_Error_expected_substitution_or_repeat_number] = "expected a substitution or repeat number",
+    [HGVS_Error_expected_sequence]                      = "expected a sequence",
+    [HGVS_Error_expected_sequence_or_description]       = "expected a sequence or description",
+    [HGVS_Error_expected_length]                        = "expected a length",
+    [HGVS_Error_expected_inserted_part]                 = "expected an inserted part",
+    [HGVS_Error_expected_colon]                         = "expected: ':'",
+    [HGVS_Error_expected_underscore]                    = "expected: '_'",
+    [HGVS_Error_expected_closing_parenthesis]           = "expected: ')'",
+    [HGVS_Error_expected_closing_bracket]               = "expected: ']'",
+}; // ERROR_MESSAGES
+
+
+#if defined(STATS)
+
+
+// Built with OPTIONS=STATS, each parser counts the calls of every
+// production, the alternatives that fail to match, the errors and their
+// frames, the nodes it creates and hands back, and the calls of every
+// lexer function with the bytes each consumes; see
+// HGVS_result_print_stats().
+#define PRODUCTIONS(X)                         \
+    X(unknown)                          \
+    X(number)                           \
+    X(unknown_or_number)                \
+    X(sequence)                         \
+    X(identifier)                       \
+    X(reference)                        \
+    X(description)                      \
+    X(offset)                           \
+    X(point)                            \
+    X(uncertain_point)                  \
+    X(uncertain_point_or_point)         \
+    X(location)                         \
+    X(sequence_or_location)             \
+    X(unknown_or_number_or_exact_range) \
+    X(repeated)                         \
+    X(repeat)                           \
+    X(compound_repeat)                  \
+    X(substitution_or_repeat)           \
+    X(length)                           \
+    X(length_or_unknown_or_number)      \
+    X(sequence_or_length)               \
+    X(sequence_or_description)          \
+    X(location_or_length)               \
+    X(insert)                           \
+    X(inserted)                         \
+    X(substitution)                     \
+    X(insertion)                        \
+    X(deletion_or_deletion_insertion)   \
+    X(duplication)                      \
+    X(conversion)                       \
+    X(inversion)                        \
+    X(equal)                            \
+    X(variant)                          \
+    X(allele)
+
+
+enum Production
+{
+#define X(name) PRODUCTION_##name,
+    PRODUCTIONS(X)
+#undef X
+    PRODUCTION_COUNT
+};
+
+
+static char const* const PRODUCTION_NAMES[] =
+{
+#define X(name) #name,
+    PRODUCTIONS(X)
+#undef X
+};
+
+
+#define LEXERS(X)     \
+    X(match_alpha)      \
+    X(match_char)       \
+    X(match_number)     \
+    X(match_sequence)   \
+    X(match_identifier) \
+    X(match_string)     \
+    X(peek_string)      \
+    X(skip_identifier)
+
+
+enum Lexer
+{
+#define X(name) LEXER_##name,
+    LEXERS(X)
+#undef X
+    LEXER_COUNT
+};
+
+
+static char const* const LEXER_NAMES[] =
+{
+#define X(name) #name,
+    LEXERS(X)
+#undef X
+};
+
+
+typedef struct Stats
+{
+    size_t parses;
+    size_t calls[PRODUCTION_COUNT];
+    size_t unmatched;  // unmatched() calls: failed alternatives
+    size_t errors;
+    size_t frames;     // error() and frame() calls
+    size_t created;
+    size_t destroyed;
+    size_t lexed[LEXER_COUNT];
+    size_t scanned[LEXER_COUNT];  // bytes consumed (peek_string(): matched)
+} Stats;
+
+
+#define STAT(parser, counter)      ((parser)->stats.counter += 1)
+#define STAT_CALL(parser, name)    STAT(parser, calls[PRODUCTION_##name])
+
+#else
+
+#define STAT(parser, counter)      ((void) (parser))
+#define STAT_CALL(parser, name)    ((void) (parser))
+
+#endif
+
+
+typedef struct Parser
+{
+    Node*  nodes;
+    size_t count;
+    size_t capacity;
+
+    char const* start;
+    char const* end;
+
+    // the elements of the compounds being matched, innermost last; see
+    // items()
+    Index* pending;
+    size_t pending_count;
+    size_t pending_capacity;
+
+    bool   recognize;
+    bool   trace;
+    size_t depth;  // of nesting, see NESTING_LIMIT
+
+#if defined(STATS)
+    Stats stats;
+#endif
+} Parser;
+
+
+#if defined(STATS)
+
+
+static inline void
+lexed(Parser* const      parser,
+      enum Lexer const   lexer,
+      char const* const  from,
+      char const* const  to)
+{
+    parser->stats.lexed[lexer] += 1;
+    parser->stats.scanned[lexer] += to - from;
+} // lexed
+
+
+// The productions call the lexer through these, as the macros below
+// stand for the lexer functions from here on.
+static inline bool
+counted_match_alpha(Parser* const parser, char const** const ptr, char const* const end, size_t* const ch)
+{
+    char const* const from = *ptr;
+    bool const res = match_alpha(ptr, end, ch);
+    lexed(parser, LEXER_match_alpha, from, *ptr);
+    return res;
+} // counted_match_alpha
+
+
+static inline bool
+counted_match_char(Parser* const parser, char const** const ptr, char const* const end, char const ch)
+{
+    char const* const from = *ptr;
+    bool const res = match_char(ptr, end, ch);
+    lexed(parser, LEXER_match_char, from, *ptr);
+    return res;
+} // counted_match_char
+
+
+static inline enum Number_Match
+counted_match_number(Parser* const parser, char const** const ptr, char const* const end, size_t* const num)
+{
+    char const* const from = *ptr;
+    enum Number_Match const res = match_number(ptr, end, num);
+    lexed(parser, LEXER_match_number, from, *ptr);
+    return res;
+} // counted_match_number
+
+
+static inline bool
+counted_match_sequence(Parser* const parser, char const** const ptr, char const* const end, size_t* const len)
+{
+    char const* const from = *ptr;
+    bool const res = match_sequence(ptr, end, len);
+    lexed(parser, LEXER_match_sequence, from, *ptr);
+    return res;
+} // counted_match_sequence
+
+
+static inline bool
+counted_match_identifier(Parser* const parser, char const** const ptr, char const* const end, size_t* const len)
+{
+    char const* const from = *ptr;
+    bool const res = match_identifier(ptr, end, len);
+    lexed(parser, LEXER_match_identifier, from, *ptr);
+    return res;
+} // counted_match_identifier
+
+
+static inline bool
+counted_match_string(Parser* const parser, char const** const ptr, char const* const end, char const* const str)
+{
+    char const* const from = *ptr;
+    bool const res = match_string(ptr, end, str);
+    lexed(parser, LEXER_match_string, from, *ptr);
+    return res;
+} // counted_match_string
+
+
+static inline bool
+counted_peek_string(Parser* const parser, char const* const ptr, char const* const end, char const* const str)
+{
+    bool const res = peek_string(ptr, end, str);
+    lexed(parser, LEXER_peek_string, ptr, res ? ptr + strlen(str) : ptr);
+    return res;
+} // counted_peek_string
+
+
+static inline char const*
+counted_skip_identifier(Parser* const parser, char const* const ptr, char const* const end)
+{
+    char const* const res = skip_identifier(ptr, end);
+    lexed(parser, LEXER_skip_identifier, ptr, res);
+    return res;
+} // counted_skip_identifier
+
+
+#define match_alpha(ptr, end, ch)       counted_match_alpha(parser, ptr, end, ch)
+#define match_char(ptr, end, ch)        counted_match_char(parser, ptr, end, ch)
+#define match_number(ptr, end, num)     counted_match_number(parser, ptr, end, num)
+#define match_sequence(ptr, end, len)   counted_match_sequence(parser, ptr, end, len)
+#define match_identifier(ptr, end, len) counted_match_identifier(parser, ptr, end, len)
+#define match_string(ptr, end, str)     counted_match_string(parser, ptr, end, str)
+#define peek_string(ptr, end, str)      counted_peek_string(parser, ptr, end, str)
+#define skip_identifier(ptr, end)       counted_skip_identifier(parser, ptr, end)
+
+#endif
+
+
+static inline Node*
+at(Parser const* const parser, Index const index)
+{
+    return &parser->nodes[index < VIRTUAL ? index : SCRATCH];
+} // at
+
+
+static inline char const*
+begin(Parser const* const parser, Index const index)
+{
+    if (index >= VIRTUAL)
+    {
+        return parser->start + (index - VIRTUAL);
+    } // if
+    return parser->start + at(parser, index)->offset;
+} // begin
+
+
+// Numbers and error messages need more than 32 bits. Both are kept in
+// nodes without a right child, whose right index holds the upper half.
+static inline void
+set_wide(Node* const node, uint64_t const value)
+{
+    node->data = (uint32_t) value;
+    node->right = (uint32_t) (value >> 32);
+} // set_wide
+
+
+static inline uint64_t
+wide(Node const* const node)
+{
+    return node->data | (uint64_t) node->right << 32;
+} // wide
+
+
+static inline char const*
+message(Node const* const node)
+{
+    return (char const*) (uintptr_t) wide(node);
+} // message
 
 
 static inline bool
-is_error(Node* const node)
+is_error(Parser const* const parser, Index const node)
 {
-    return node != NULL && node->type == NODE_ERROR;
+    return node != NONE && at(parser, node)->type == HGVS_Node_error;
 } // is_error
 
 
+// Sets up an empty node array: NONE, ALLOCATION_ERROR and the error
+// record are always present, so the parser never has to special case
+// them.
+static bool
+parser_init(Parser* const parser)
+{
+    parser->nodes = malloc(NODES_INITIAL * sizeof(*parser->nodes));
+    if (parser->nodes == NULL)
+    {
+        return false;
+    } // if
+    parser->capacity = NODES_INITIAL;
+    parser->count = FIRST;
+    parser->pending = NULL;
+    parser->pending_count = 0;
+    parser->pending_capacity = 0;
+    parser->start = NULL;
+    parser->end = NULL;
+    parser->recognize = false;
+    parser->trace = false;
+    parser->depth = 0;
+#if defined(STATS)
+    memset(&parser->stats, 0, sizeof(parser->stats));
+#endif
+
+    Node* const node = at(parser, ALLOCATION_ERROR);
+    node->left = NONE;
+    node->offset = 0;
+    node->type = HGVS_Node_allocation_error;
+    set_wide(node, (uintptr_t) ALLOCATION_ERROR_MESSAGE);
+
+    Node const scratch = {
+        .left   = NONE,
+        .right  = NONE,
+        .offset = 0,
+        .data   = 0,
+        .type   = HGVS_Node_unknown
+    }; // scratch
+    *at(parser, SCRATCH) = scratch;
+
+    Node const record = {
+        .left   = ERROR_CONTEXT,
+        .right  = NONE,
+        .offset = 0,
+        .data   = HGVS_Error_none,
+        .type   = HGVS_Node_error
+    }; // record
+    *at(parser, ERROR) = record;
+
+    Node const context = {
+        .left   = NONE,
+        .right  = NONE,
+        .offset = 0,
+        .data   = 0,
+        .type   = HGVS_Node_error_context
+    }; // context
+    *at(parser, ERROR_CONTEXT) = context;
+    return true;
+} // parser_init
+
+
+static inline void
+parser_reset(Parser* const parser, char const* const str, size_t const len)
+{
+    parser->count = FIRST;
+    parser->pending_count = 0;
+    parser->start = str;
+    parser->end = str + len;
+} // parser_reset
+
+
+static void
+parser_destroy(Parser* const parser)
+{
+    free(parser->nodes);
+    parser->nodes = NULL;
+    parser->count = 0;
+    parser->capacity = 0;
+    free(parser->pending);
+    parser->pending = NULL;
+    parser->pending_count = 0;
+    parser->pending_capacity = 0;
+} // parser_destroy
+
+
+static bool
+parser_grow(Parser* const parser)
+{
+    if (parser->capacity > UINT32_MAX / 2)
+    {
+        return false;
+    } // if
+    Node* const nodes = realloc(parser->nodes, 2 * parser->capacity * sizeof(*nodes));
+    if (nodes == NULL)
+    {
+        return false;
+    } // if
+    parser->nodes = nodes;
+    parser->capacity *= 2;
+    return true;
+} // parser_grow
+
+
+// Nodes are reclaimed all at once by the next parse; only a node that is
+// the most recent allocation (a failed leaf) is handed back immediately.
 static inline void
-destroy(Node* const node)
+destroy(Parser* const parser, Index const node)
 {
-    if (node != NULL && node != &ALLOCATION_ERROR)
+    if (node >= FIRST && node == parser->count - 1)
     {
-        destroy(node->left);
-        destroy(node->right);
-        free(node);
+        STAT(parser, destroyed);
+        parser->count -= 1;
     } // if
 } // destroy
 
 
-static inline Node*
-allocation_error(Node* const node)
+static inline Index
+allocation_error(Parser* const parser, Index const node)
 {
-    destroy(node);
-    return &ALLOCATION_ERROR;
+    destroy(parser, node);
+    return ALLOCATION_ERROR;
 } // allocation_error
 
 
-static inline Node*
-unmatched(Node* const node)
+static inline Index
+unmatched(Parser* const parser, Index const node)
 {
-    destroy(node);
-    return NULL;
+    STAT(parser, unmatched);
+    destroy(parser, node);
+    return NONE;
 } // unmatched
 
 
-static inline Node*
-create(enum Node_Type const type)
+// Any Node* obtained with at() is invalidated by create().
+static inline Index
+create(Parser* const parser, enum HGVS_Node_Type const type, char const* const ptr)
 {
-    Node* const node = malloc(sizeof(*node));
-    if (node == NULL)
+    if (parser->recognize)
+    {
+        return VIRTUAL | (ptr - parser->start);
+    } // if
+    if (parser->count == parser->capacity && !parser_grow(parser))
     {
-        return allocation_error(NULL);
+        return ALLOCATION_ERROR;
     } // if
 
-    node->left = NULL;
-    node->right = NULL;
+    STAT(parser, created);
+    Index const index = parser->count;
+    parser->count += 1;
+
+    Node* const node = at(parser, index);
+    node->left = NONE;
+    node->right = NONE;
 
+    node->offset = ptr - parser->start;
     node->data = 0;
-    node->ptr = NULL;
 
     node->type = type;
 
-    return node;
+    return index;
 } // create
 
 
-static inline Node*
-error(Node* const       cxt,
-      Node* const       err,
+// Adds an element to the compound being matched. An error abandons the
+// whole parse, so the elements of a failed compound are only dropped by
+// the next one.
+static inline bool
+pend(Parser* const parser, Index const index)
+{
+    if (parser->recognize)
+    {
+        return true;
+    } // if
+    if (parser->pending_count == parser->pending_capacity)
+    {
+        size_t const capacity = parser->pending_capacity > 0 ? 2 * parser->pending_capacity : PENDING_INITIAL;
+        Index* const pending = realloc(parser->pending, capacity * sizeof(*pending));
+        if (pending == NULL)
+        {
+            return false;
+        } // if
+        parser->pending = pending;
+        parser->pending_capacity = capacity;
+    } // if
+    parser->pending[parser->pending_count] = index;
+    parser->pending_count += 1;
+    return true;
+} // pend
+
+
+static inline Index
+pending_at(Parser const* const parser, size_t const index, size_t const end)
+{
+    return index < end ? parser->pending[index] : NONE;
+} // pending_at
+
+
+// Moves the elements pended since base to the item nodes of a compound.
+static Index
+items(Parser* const parser, Index const node, size_t const base)
+{
+    size_t const end = parser->pending_count;
+    parser->pending_count = base;
+    if (parser->recognize)
+    {
+        return node;
+    } // if
+
+    size_t const count = (end - base + ITEMS_PER_NODE - 1) / ITEMS_PER_NODE;
+    while (parser->capacity - parser->count < count)
+    {
+        if (!parser_grow(parser))
+        {
+            return allocation_error(parser, node);
+        } // if
+    } // while
+
+    Index const first = parser->count;
+    for (size_t i = base; i < end; i += ITEMS_PER_NODE)
+    {
+        STAT(parser, created);
+        Node const item = {
+            .left   = pending_at(parser, i, end),
+            .right  = pending_at(parser, i + 1, end),
+            .offset = pending_at(parser, i + 2, end),
+            .data   = pending_at(parser, i + 3, end),
+            .type   = ITEMS
+        }; // item
+        *at(parser, parser->count) = item;
+        parser->count += 1;
+    } // for
+
+    at(parser, node)->left = first;
+    at(parser, node)->data = end - base;
+    return node;
+} // items
+
+
+// The element at index of a compound: the four indices of an item node
+// are its first four fields, in one load instead of a switch on them.
+static inline Index
+item(Parser const* const parser, Node const* const node, size_t const index)
+{
+    char const* const items = (char const*) at(parser, node->left + index / ITEMS_PER_NODE);
+    Index res;
+    memcpy(&res, items + index % ITEMS_PER_NODE * sizeof(res), sizeof(res));
+    return res;
+} // item
+
+
+static Index
+chain(Parser* const     parser,
+      Index const       cxt,
+      Index const       err,
       char const* const ptr,
       char const* const msg)
 {
-    Node* const node = create(NODE_ERROR);
-    if (node == &ALLOCATION_ERROR)
+    Index const node = create(parser, HGVS_Node_error, ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        destroy(cxt);
-        destroy(err);
-        return allocation_error(NULL);
+        destroy(parser, cxt);
+        destroy(parser, err);
+        return allocation_error(parser, NONE);
     } // if
 
-    node->left = create(NODE_ERROR_CONTEXT);
-    if (node->left == &ALLOCATION_ERROR)
+    Index const context = create(parser, HGVS_Node_error_context, ptr);
+    if (context == ALLOCATION_ERROR)
     {
-        destroy(cxt);
-        destroy(err);
-        return allocation_error(NULL);
+        destroy(parser, cxt);
+        destroy(parser, err);
+        return allocation_error(parser, NONE);
     } // if
-    node->left->left = cxt;
-    node->left->ptr = msg;
+    at(parser, context)->left = cxt;
+    set_wide(at(parser, context), (uintptr_t) msg);
+
+    at(parser, node)->left = context;
+    at(parser, node)->right = err;
+
+    return node;
+} // chain
 
-    node->right = err;
 
-    node->ptr = ptr;
+// The innermost error: with a trace the first link of a chain of
+// errors, otherwise recorded in ERROR. The grammar never backtracks
+// over an error, so there is one per parse.
+static inline Index
+error(Parser* const          parser,
+      Index const            cxt,
+      enum HGVS_Error const  code,
+      char const* const      ptr)
+{
+    STAT(parser, errors);
+    STAT(parser, frames);
+    if (!parser->trace)
+    {
+        Node* const node = at(parser, ERROR);
+        node->offset = ptr - parser->start;
+        node->data = code;
+        set_wide(at(parser, ERROR_CONTEXT), (uintptr_t) ERROR_MESSAGES[code]);
+        return ERROR;
+    } // if
 
+    Index const node = chain(parser, cxt, NONE, ptr, ERROR_MESSAGES[code]);
+    if (node != ALLOCATION_ERROR)
+    {
+        at(parser, node)->data = code;
+    } // if
     return node;
 } // error
 
 
-static Node*
-allele(char const** const ptr);
+// The context of an error: only with a trace.
+static inline Index
+frame(Parser* const     parser,
+      Index const       cxt,
+      Index const       err,
+      char const* const ptr,
+      char const* const msg)
+{
+    STAT(parser, frames);
+    if (!parser->trace)
+    {
+        return err;
+    } // if
+    return chain(parser, cxt, err, ptr, msg);
+} // frame
+
+
+static Index
+allele(Parser* const parser, char const** const ptr);
 
 
-static Node*
-unknown(char const** const ptr)
+static Index
+unknown(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_UNKNOWN);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, unknown);
+    Index const node = create(parser, HGVS_Node_unknown, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    if (!match_char(ptr, '?'))
+    if (!match_char(ptr, parser->end, '?'))
     {
-        return unmatched(node);
+        return unmatched(parser, node);
     } // if
     return node;
 } // unknown
 
 
-static Node*
-number(char const** const ptr)
+static Index
+number(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_NUMBER);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, number);
+    Index const node = create(parser, HGVS_Node_number, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    if (!match_number(ptr, &node->data))
+    size_t value = 0;
+    enum Number_Match const match = match_number(ptr, parser->end, &value);
+    if (match == NUMBER_UNMATCHED)
     {
-        return unmatched(node);
+        return unmatched(parser, node);
     } // if
+    if (match == NUMBER_OVERFLOW)
+    {
+        return error(parser, node, HGVS_Error_number_too_large, begin(parser, node));
+    } // if
+    set_wide(at(parser, node), value);
     return node;
 } // number
 
 
-static Node*
-unknown_or_number(char const** const ptr)
+static Index
+unknown_or_number(Parser* const parser, char const** const ptr)
 {
-    Node* node = unknown(ptr);
-    if (node == NULL)
+    STAT_CALL(parser, unknown_or_number);
+    Index node = unknown(parser, ptr);
+    if (node == NONE)
     {
-        node = number(ptr);
-        if (node == NULL)
+        node = number(parser, ptr);
+        if (node == NONE)
         {
-            return unmatched(NULL);
+            return unmatched(parser, NONE);
         } // if
     } // if
     return node;
 } // unknown_or_number
 
 
-static Node*
-sequence(char const** const ptr)
+static Index
+sequence(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_SEQUENCE);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, sequence);
+    Index const node = create(parser, HGVS_Node_sequence, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
-    if (!match_sequence(ptr, &node->data))
+    size_t len = 0;
+    if (!match_sequence(ptr, parser->end, &len))
     {
-        return unmatched(node);
+        return unmatched(parser, node);
     } // if
+    at(parser, node)->data = len;
     return node;
 } // sequence
 
 
-static Node*
-identifier(char const** const ptr)
+static Index
+identifier(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_IDENTIFIER);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, identifier);
+    Index const node = create(parser, HGVS_Node_identifier, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
-    if (!match_identifier(ptr, &node->data))
+    size_t len = 0;
+    if (!match_identifier(ptr, parser->end, &len))
     {
-        return unmatched(node);
+        return unmatched(parser, node);
     } // if
+    at(parser, node)->data = len;
     return node;
 } // identifier
 
 
-static Node*
-reference(char const** const ptr)
+static Index
+reference(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_REFERENCE);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, reference);
+    Index const node = create(parser, HGVS_Node_reference, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    Node* probe = identifier(ptr);
-    if (probe == NULL)
+    Index probe = identifier(parser, ptr);
+    if (probe == NONE)
     {
-        return error(node, NULL, *ptr, "expected an identifier");
+        return error(parser, node, HGVS_Error_expected_identifier, *ptr);
     } // if
-    if (is_error(probe))
+    if (is_error(parser, probe))
     {
-        return error(node, probe, node->ptr, "while matching an identifier");
+        return frame(parser, node, probe, begin(parser, node), "while matching an identifier");
     } // if
-    node->left = probe;
+    at(parser, node)->left = probe;
 
-    if (match_char(ptr, '('))
+    if (match_char(ptr, parser->end, '('))
     {
-        probe = reference(ptr);
-        if (probe == NULL)
+        if (parser->depth == NESTING_LIMIT)
         {
-            return error(node, NULL, *ptr, "expected a reference");
+            return error(parser, node, HGVS_Error_nesting_too_deep, *ptr);
         } // if
-        if (is_error(probe))
+        parser->depth += 1;
+        probe = reference(parser, ptr);
+        parser->depth -= 1;
+        if (probe == NONE)
         {
-            return error(node, probe, node->ptr, "while matching a reference");
+            return error(parser, node, HGVS_Error_expected_reference, *ptr);
         } // if
-        node->right = probe;
+        if (is_error(parser, probe))
+        {
+            return frame(parser, node, probe, begin(parser, node), "while matching a reference");
+        } // if
+        at(parser, node)->right = probe;
 
-        if (!match_char(ptr, ')'))
+        if (!match_char(ptr, parser->end, ')'))
         {
-            return error(node, NULL, *ptr, "expected: ')'");
+            return error(parser, node, HGVS_Error_expected_closing_parenthesis, *ptr);
         } // if
     } // if
     return node;
 } // reference
 
 
-static Node*
-description(char const** const ptr)
+static Index
+description(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_DESCRIPTION);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, description);
+    Index const node = create(parser, HGVS_Node_description, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    Node* probe = reference(ptr);
-    if (probe == NULL)
+    Index probe = reference(parser, ptr);
+    if (probe == NONE)
     {
-        return error(node, NULL, *ptr, "expected a reference");
+        return error(parser, node, HGVS_Error_expected_reference, *ptr);
     } // if
-    if (is_error(probe))
+    if (is_error(parser, probe))
     {
-        return error(node, probe, node->ptr, "while matching a description");
+        return frame(parser, node, probe, begin(parser, node), "while matching a description");
     } // if
-    node->left = probe;
+    at(parser, node)->left = probe;
 
-    if (!match_char(ptr, ':'))
+    if (!match_char(ptr, parser->end, ':'))
     {
-        return error(node, error(NULL, NULL, *ptr, "expected: ':'"), node->ptr, "while matching a description");
+        return frame(parser, node, error(parser, NONE, HGVS_Error_expected_colon, *ptr), begin(parser, node), "while matching a description");
     } // if
 
-    node->data = 0;
-    if (match_alpha(ptr, &node->data))
+    size_t system = 0;
+    if (match_alpha(ptr, parser->end, &system))
     {
-        if (!match_char(ptr, '.'))
+        if (!match_char(ptr, parser->end, '.'))
         {
-            return error(node, NULL, *ptr, "expected a coordinate system");
+            return error(parser, node, HGVS_Error_expected_coordinate_system, *ptr);
         } // if
     } // if
+    at(parser, node)->data = system;
 
-    probe = allele(ptr);
-    if (probe == NULL)
+    probe = allele(parser, ptr);
+    if (probe == NONE)
     {
-        return error(node, NULL, *ptr, "expected an allele");
+        return error(parser, node, HGVS_Error_expected_allele, *ptr);
     } // if
-    if (is_error(probe))
+    if (is_error(parser, probe))
     {
-        return error(node, probe, node->ptr, "while matching a description");
+        return frame(parser, node, probe, begin(parser, node), "while matching a description");
     } // if
-    node->right = probe;
+    at(parser, node)->right = probe;
 
     return node;
 } // description
 
 
-static Node*
-offset(char const** const ptr)
+static Index
+offset(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_OFFSET);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, offset);
+    Index const node = create(parser, HGVS_Node_offset, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
     bool matched = false;
-    if (match_char(ptr, '+'))
+    if (match_char(ptr, parser->end, '+'))
     {
         matched = true;
-        node->data = NODE_POSITIVE_OFFSET;
+        at(parser, node)->data = HGVS_NODE_POSITIVE_OFFSET;
     } // if
-    else if (match_char(ptr, '-'))
+    else if (match_char(ptr, parser->end, '-'))
     {
         matched = true;
-        node->data = NODE_NEGATIVE_OFFSET;
+        at(parser, node)->data = HGVS_NODE_NEGATIVE_OFFSET;
     } // if
 
     if (matched)
     {
-        Node* const probe = unknown_or_number(ptr);
-        if (probe == NULL)
+        Index const probe = unknown_or_number(parser, ptr);
+        if (probe == NONE)
         {
-            return error(node, NULL, *ptr, "expected an offset");
+            return error(parser, node, HGVS_Error_expected_offset, *ptr);
         } // if
-        if (is_error(probe))
+        if (is_error(parser, probe))
         {
-            return error(node, probe, node->ptr, "while matching an offset");
+            return frame(parser, node, probe, begin(parser, node), "while matching an offset");
         } // if
-        node->left = probe;
+        at(parser, node)->left = probe;
 
         return node;
     } // if
-    return unmatched(node);
+    return unmatched(parser, node);
 } // offset
 
 
-static Node*
-point(char const** const ptr)
+static Index
+point(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_POINT);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, point);
+    Index const node = create(parser, HGVS_Node_point, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    if (match_char(ptr, '*'))
+    if (match_char(ptr, parser->end, '*'))
     {
-        node->data = NODE_DOWNSTREAM;
+        at(parser, node)->data = HGVS_NODE_DOWNSTREAM;
     } // if
-    else if (match_char(ptr, '-'))
+    else if (match_char(ptr, parser->end, '-'))
     {
-        node->data = NODE_UPSTREAM;
+        at(parser, node)->data = HGVS_NODE_UPSTREAM;
     } // if
 
-    Node* probe = unknown_or_number(ptr);
-    if (probe == NULL)
+    Index probe = unknown_or_number(parser, ptr);
+    if (probe == NONE)
     {
-        return unmatched(node);
+        return unmatched(parser, node);
     } // if
-    if (is_error(probe))
+    if (is_error(parser, probe))
     {
-        return error(node, probe, node->ptr, "while matching an exact point");
+        return frame(parser, node, probe, begin(parser, node), "while matching an exact point");
     } // if
-    node->left = probe;
+    at(parser, node)->left = probe;
 
-    probe = offset(ptr);
-    if (is_error(probe))
+    probe = offset(parser, ptr);
+    if (is_error(parser, probe))
     {
-        return error(node, probe, node->ptr, "while matching an exact point");
+        return frame(parser, node, probe, begin(parser, node), "while matching an exact point");
     } // if
-    node->right = probe;
+    at(parser, node)->right = probe;
 
     return node;
 } // point
 
 
-static Node*
-uncertain_point(char const** const ptr)
+static Index
+uncertain_point(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_UNCERTAIN_POINT);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, uncertain_point);
+    Index const node = create(parser, HGVS_Node_uncertain_point, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    if (match_char(ptr, '('))
+    if (match_char(ptr, parser->end, '('))
     {
-        Node* probe = point(ptr);
-        if (probe == NULL)
+        Index probe = point(parser, ptr);
+        if (probe == NONE)
         {
-            return error(node, error(NULL, NULL, *ptr, "expected an exact point (start)"), node->ptr, "while matching an uncertain point");
+            return frame(parser, node, error(parser, NONE, HGVS_Error_expected_point_start, *ptr), begin(parser, node), "while matching an uncertain point");
         } // if
-        if (is_error(probe))
+        if (is_error(parser, probe))
         {
-            return error(node, probe, node->ptr, "while matching an uncertain point");
+            return frame(parser, node, probe, begin(parser, node), "while matching an uncertain point");
         } // if
-        node->left = probe;
+        at(parser, node)->left = probe;
 
-        if (!match_char(ptr, '_'))
+        if (!match_char(ptr, parser->end, '_'))
         {
-            return error(node, error(NULL, NULL, *ptr, "expected: '_'"), node->ptr, "while matching an uncertain point");
+            return frame(parser, node, error(parser, NONE, HGVS_Error_expected_underscore, *ptr), begin(parser, node), "while matching an uncertain point");
         } // if
 
-        probe = point(ptr);
-        if (probe == NULL)
+        probe = point(parser, ptr);
+        if (probe == NONE)
         {
-            return error(node, error(NULL, NULL, *ptr, "expected an exact point (end)"), node->ptr, "while matching an uncertain point");
+            return frame(parser, node, error(parser, NONE, HGVS_Error_expected_point_end, *ptr), begin(parser, node), "while matching an uncertain point");
         } // if
-        if (is_error(probe))
+        if (is_error(parser, probe))
         {
-            return error(node, probe, node->ptr, "while matching an uncertain point");
+            return frame(parser, node, probe, begin(parser, node), "while matching an uncertain point");
         } // if
-        node->right = probe;
+        at(parser, node)->right = probe;
 
-        if (!match_char(ptr, ')'))
+        if (!match_char(ptr, parser->end, ')'))
         {
-            return error(node, error(NULL, NULL, *ptr, "expected: ')'"), node->ptr, "while matching an uncertain point");
+            return frame(parser, node, error(parser, NONE, HGVS_Error_expected_closing_parenthesis, *ptr), begin(parser, node), "while matching an uncertain point");
         } // if
 
         return node;
     } // if
-    return unmatched(node);
+    return unmatched(parser, node);
 } // uncertain_point
 
 
-static Node*
-uncertain_point_or_point(char const** const ptr)
+static Index
+uncertain_point_or_point(Parser* const parser, char const** const ptr)
 {
+    STAT_CALL(parser, uncertain_point_or_point);
     char const* const err = *ptr;
-    Node* node = uncertain_point(ptr);
-    if (is_error(node))
+    Index node = uncertain_point(parser, ptr);
+    if (is_error(parser, node))
     {
         return node;
     } // if
 
-    if (node == NULL)
+    if (node == NONE)
     {
-        node = point(ptr);
-        if (node == NULL)
+        node = point(parser, ptr);
+        if (node == NONE)
         {
-            return unmatched(NULL);
+            return unmatched(parser, NONE);
         } // if
-        if (is_error(node))
+        if (is_error(parser, node))
         {
-            return error(NULL, node, err, "while matching an exact point");
+            return frame(parser, NONE, node, err, "while matching an exact point");
         } // if
     } // if
     return node;
 } // uncertain_point_or_point
 
 
-static Node*
-location(char const** const ptr)
+static Index
+location(Parser* const parser, char const** const ptr)
 {
+    STAT_CALL(parser, location);
     char const* const err = *ptr;
-    Node* probe = uncertain_point_or_point(ptr);
-    if (probe == NULL)
+    Index probe = uncertain_point_or_point(parser, ptr);
+    if (probe == NONE)
     {
-        return unmatched(NULL);
+        return unmatched(parser, NONE);
     } // if
-    if (is_error(probe))
+    if (is_error(parser, probe))
     {
-        return error(NULL, probe, err, "while matching a location");
+        return frame(parser, NONE, probe, err, "while matching a location");
     } // if
 
-    if (match_char(ptr, '_'))
+    if (match_char(ptr, parser->end, '_'))
     {
-        Node* const node = create(NODE_RANGE);
-        if (node == &ALLOCATION_ERROR)
+        Index const node = create(parser, HGVS_Node_range, err);
+        if (node == ALLOCATION_ERROR)
         {
-            return allocation_error(NULL);
+            return allocation_error(parser, NONE);
         } // if
-        node->left = probe;
+        at(parser, node)->left = probe;
 
-        probe = uncertain_point_or_point(ptr);
-        if (probe == NULL)
+        probe = uncertain_point_or_point(parser, ptr);
+        if (probe == NONE)
         {
-            return error(node, error(NULL, NULL, *ptr, "expected a point (exact or uncertain)"), err, "while matching a location (range)");
+            return frame(parser, node, error(parser, NONE, HGVS_Error_expected_point, *ptr), err, "while matching a location (range)");
         } // if
-        if (is_error(probe))
+        if (is_error(parser, probe))
         {
-            return error(node, probe, err, "while matching a location (range)");
+            return frame(parser, node, probe, err, "while matching a location (range)");
         } // if
-        node->right = probe;
+        at(parser, node)->right = probe;
 
         return node;
     } // if
@@ -539,60 +1130,62 @@ location(char const** const ptr)
 } // location
 
 
-static Node*
-sequence_or_location(char const** const ptr)
+static Index
+sequence_or_location(Parser* const parser, char const** const ptr)
 {
+    STAT_CALL(parser, sequence_or_location);
     char const* const err = *ptr;
-    Node* node = sequence(ptr);
-    if (node == NULL)
+    Index node = sequence(parser, ptr);
+    if (node == NONE)
     {
-        node = location(ptr);
-        if (node == NULL)
+        node = location(parser, ptr);
+        if (node == NONE)
         {
-            return unmatched(NULL);
+            return unmatched(parser, NONE);
         } // if
-        if (is_error(node))
+        if (is_error(parser, node))
         {
-            return error(NULL, node, err, "while matching a location");
+            return frame(parser, NONE, node, err, "while matching a location");
         } // if
     } // if
     return node;
 } // sequence_or_location
 
 
-static Node*
-unknown_or_number_or_exact_range(char const** const ptr)
+static Index
+unknown_or_number_or_exact_range(Parser* const parser, char const** const ptr)
 {
+    STAT_CALL(parser, unknown_or_number_or_exact_range);
     char const* const err = *ptr;
-    Node* probe = unknown_or_number(ptr);
-    if (probe == NULL)
+    Index probe = unknown_or_number(parser, ptr);
+    if (probe == NONE)
     {
-        return unmatched(NULL);
+        return unmatched(parser, NONE);
     } // if
-    if (is_error(probe))
+    if (is_error(parser, probe))
     {
-        return error(NULL, probe, err, "while matching an unknown, number or exact range");
+        return frame(parser, NONE, probe, err, "while matching an unknown, number or exact range");
     } // if
 
-    if (match_char(ptr, '_'))
+    if (match_char(ptr, parser->end, '_'))
     {
-        Node* const node = create(NODE_RANGE);
-        if (node == &ALLOCATION_ERROR)
+        Index const node = create(parser, HGVS_Node_range, err);
+        if (node == ALLOCATION_ERROR)
         {
-            return allocation_error(probe);
+            return allocation_error(parser, probe);
         } // if
-        node->left = probe;
+        at(parser, node)->left = probe;
 
-        probe = unknown_or_number(ptr);
-        if (probe == NULL)
+        probe = unknown_or_number(parser, ptr);
+        if (probe == NONE)
         {
-            return error(node, NULL, *ptr, "expected an unknown or number");
+            return error(parser, node, HGVS_Error_expected_unknown_or_number, *ptr);
         } // if
-        if (is_error(probe))
+        if (is_error(parser, probe))
         {
-            return error(node, probe, err, "while matching an exact range");
+            return frame(parser, node, probe, err, "while matching an exact range");
         } // if
-        node->right = probe;
+        at(parser, node)->right = probe;
 
         return node;
     } // if
@@ -600,1109 +1193,2086 @@ unknown_or_number_or_exact_range(char const** const ptr)
 } // unknown_or_number_or_exact_range
 
 
-static Node*
-repeated(char const** const ptr)
+static Index
+repeated(Parser* const parser, char const** const ptr)
 {
+    STAT_CALL(parser, repeated);
     char const* const err = *ptr;
-    if (!match_char(ptr, '['))
+    if (!match_char(ptr, parser->end, '['))
     {
-        return unmatched(NULL);
+        return unmatched(parser, NONE);
     } // if
 
-    Node* const node = unknown_or_number_or_exact_range(ptr);
-    if (node == NULL)
+    Index const node = unknown_or_number_or_exact_range(parser, ptr);
+    if (node == NONE)
     {
-        return error(NULL, NULL, *ptr, "a repeat number");
+        return error(parser, NONE, HGVS_Error_expected_repeat_number, *ptr);
     } // if
-    if (is_error(node))
+    if (is_error(parser, node))
     {
-        return error(NULL, node, err, "while matching a repeat number");
+        return frame(parser, NONE, node, err, "while matching a repeat number");
     } // if
 
-    if (!match_char(ptr, ']'))
+    if (!match_char(ptr, parser->end, ']'))
     {
-        return error(node, NULL, *ptr, "expected: ']'");
+        return error(parser, node, HGVS_Error_expected_closing_bracket, *ptr);
     } // if
 
     return node;
 } // repeated
 
 
-static Node*
-repeat(char const** const ptr)
+static Index
+repeat(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_REPEAT);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, repeat);
+    Index const node = create(parser, HGVS_Node_repeat, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    Node* probe = sequence_or_location(ptr);
-    if (probe == NULL)
+    Index probe = sequence_or_location(parser, ptr);
+    if (probe == NONE)
     {
-        return unmatched(node);
+        return unmatched(parser, node);
     } // if
-    if (is_error(probe))
+    if (is_error(parser, probe))
     {
-        return error(NULL, probe, node->ptr, "while matching a repeat");
+        return frame(parser, NONE, probe, begin(parser, node), "while matching a repeat");
     } // if
-    node->left = probe;
+    at(parser, node)->left = probe;
 
-    probe = repeated(ptr);
-    if (probe == NULL)
+    probe = repeated(parser, ptr);
+    if (probe == NONE)
     {
-        return error(node, NULL, *ptr, "expected repeat number");
+        return error(parser, node, HGVS_Error_expected_repeat_number, *ptr);
     } // if
-    if (is_error(probe))
+    if (is_error(parser, probe))
     {
-        return error(node, probe, node->ptr, "while matching a repeat");
+        return frame(parser, node, probe, begin(parser, node), "while matching a repeat");
     } // if
-    node->right = probe;
+    at(parser, node)->right = probe;
 
     return node;
 } // repeat
 
 
-static Node*
-compound_repeat(char const** const ptr)
+// The repeats that follow the first; the first is all there is if none
+// do.
+static Index
+compound_repeat(Parser* const parser, char const** const ptr, Index const first)
 {
-    Node* const node = create(NODE_COMPOUND_REPEAT);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, compound_repeat);
+    Index probe = repeat(parser, ptr);
+    if (probe == NONE)
     {
-        return allocation_error(NULL);
+        return first;
     } // if
-    node->ptr = *ptr;
 
-    Node* probe = repeat(ptr);
-    if (probe == NULL)
-    {
-        return unmatched(node);
-    } // if
-    if (is_error(probe))
+    Index const node = create(parser, HGVS_Node_compound_repeat, begin(parser, first));
+    if (node == ALLOCATION_ERROR)
     {
-        return probe;
+        return allocation_error(parser, NONE);
     } // if
-    node->left = probe;
-    node->data = 1;
 
-    probe = repeat(ptr);
-    if (is_error(probe))
+    size_t const base = parser->pending_count;
+    if (!pend(parser, first))
     {
-        return probe;
+        return allocation_error(parser, node);
     } // if
-
-    Node* tmp = node;
-    while (probe != NULL)
+    while (probe != NONE)
     {
-        node->data += 1;
-        tmp->right = create(NODE_COMPOUND_REPEAT);
-        if (tmp->right == &ALLOCATION_ERROR)
+        if (is_error(parser, probe))
         {
-            return allocation_error(node);
+            return probe;
         } // if
-        tmp = tmp->right;
-        tmp->left = probe;
-        probe = repeat(ptr);
-        if (is_error(probe))
+        if (!pend(parser, probe))
         {
-            return probe;
+            return allocation_error(parser, node);
         } // if
+        probe = repeat(parser, ptr);
     } // while
-    return node;
+    return items(parser, node, base);
 } // compound_repeat
 
 
-static Node*
-substitution_or_repeat(char const** const ptr)
+static Index
+substitution_or_repeat(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_SUBSTITUTION);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, substitution_or_repeat);
+    Index const node = create(parser, HGVS_Node_substitution, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    Node* probe = sequence(ptr);
-    if (probe == NULL)
+    Index probe = sequence(parser, ptr);
+    if (probe == NONE)
     {
-        return unmatched(probe);
+        return unmatched(parser, probe);
     } // if
-    node->left = probe;
+    at(parser, node)->left = probe;
 
-    if (match_char(ptr, '>'))
+    if (match_char(ptr, parser->end, '>'))
     {
-        probe = sequence(ptr);
-        if (probe == NULL)
+        probe = sequence(parser, ptr);
+        if (probe == NONE)
         {
-            return error(node, error(NULL, NULL, *ptr, "expected a sequence"), node->ptr, "while matching a substitution");
+            return frame(parser, node, error(parser, NONE, HGVS_Error_expected_sequence, *ptr), begin(parser, node), "while matching a substitution");
         } // if
-        node->right = probe;
+        at(parser, node)->right = probe;
 
         return node;
     } // if
 
-    probe = repeated(ptr);
-    if (probe == NULL)
-    {
-        return error(node, NULL, *ptr, "expected a substitution or repeat number");
-    } // if
-    if (is_error(probe))
+    probe = repeated(parser, ptr);
+    if (probe == NONE)
     {
-        return error(node, probe, node->ptr, "while matching a repeat");
+        return error(parser, node, HGVS_Error_expected_substitution_or_repeat_number, *ptr);
     } // if
-    node->right = probe;
-    node->type = NODE_REPEAT;
-
-    probe = compound_repeat(ptr);
-    if (is_error(probe))
+    if (is_error(parser, probe))
     {
-        return error(node, probe, node->ptr, "while matching a repeat");
+        return frame(parser, node, probe, begin(parser, node), "while matching a repeat");
     } // if
+    at(parser, node)->right = probe;
+    at(parser, node)->type = HGVS_Node_repeat;
 
-    if (probe != NULL)
+    probe = compound_repeat(parser, ptr, node);
+    if (is_error(parser, probe))
     {
-        Node* const new = create(NODE_COMPOUND_REPEAT);
-        if (new == &ALLOCATION_ERROR)
-        {
-            destroy(probe);
-            return allocation_error(node);
-        } // if
-        new->ptr = *ptr;
-        new->left = node;
-        new->right = probe;
-
-        return new;
+        return frame(parser, node, probe, begin(parser, node), "while matching a repeat");
     } // if
 
-    return node;
+    return probe;
 } // substitution_or_repeat
 
 
-static Node*
-length(char const** const ptr)
+static Index
+length(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_LENGTH);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, length);
+    Index const node = create(parser, HGVS_Node_length, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    if (match_char(ptr, '('))
+    if (match_char(ptr, parser->end, '('))
     {
-        Node* const probe = unknown_or_number_or_exact_range(ptr);
-        if (probe == NULL)
+        Index const probe = unknown_or_number_or_exact_range(parser, ptr);
+        if (probe == NONE)
         {
-            return error(node, NULL, *ptr, "expected a length");
+            return error(parser, node, HGVS_Error_expected_length, *ptr);
         } // if
-        if (is_error(probe))
+        if (is_error(parser, probe))
         {
-            return error(node, probe, node->ptr, "while matching a length");
+            return frame(parser, node, probe, begin(parser, node), "while matching a length");
         } // if
-        node->left = probe;
+        at(parser, node)->left = probe;
 
-        if (!match_char(ptr, ')'))
+        if (!match_char(ptr, parser->end, ')'))
         {
-            return error(node, error(NULL, NULL, *ptr, "expected: ')'"), node->ptr, "while matching a length");
+            return frame(parser, node, error(parser, NONE, HGVS_Error_expected_closing_parenthesis, *ptr), begin(parser, node), "while matching a length");
         } // if
         return node;
     } // if
 
-    return unmatched(node);
+    return unmatched(parser, node);
 } // length
 
 
-static Node*
-length_or_unknown_or_number(char const** const ptr)
+static Index
+length_or_unknown_or_number(Parser* const parser, char const** const ptr)
 {
-    Node* node = length(ptr);
-    if (is_error(node))
+    STAT_CALL(parser, length_or_unknown_or_number);
+    Index node = length(parser, ptr);
+    if (is_error(parser, node))
     {
         return node;
     } // if
-    if (node == NULL)
+    if (node == NONE)
     {
-        return unknown_or_number(ptr);
+        return unknown_or_number(parser, ptr);
     } // if
     return node;
 } // length_or_unknown_or_number
 
 
-static Node*
-sequence_or_length(char const** const ptr)
+static Index
+sequence_or_length(Parser* const parser, char const** const ptr)
 {
-    Node* node = sequence(ptr);
-    if (node == NULL)
+    STAT_CALL(parser, sequence_or_length);
+    Index node = sequence(parser, ptr);
+    if (node == NONE)
     {
-        node = length_or_unknown_or_number(ptr);
-        if (node == NULL)
+        node = length_or_unknown_or_number(parser, ptr);
+        if (node == NONE)
         {
-            return unmatched(NULL);
+            return unmatched(parser, NONE);
         } // if
     } // if
     return node;
 } // sequence_or_length
 
 
-static Node*
-sequence_or_description(char const** const ptr)
+static Index
+sequence_or_description(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_SEQUENCE);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, sequence_or_description);
+    Index const node = create(parser, HGVS_Node_sequence, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    if (!is_alpha(**ptr))
+    if (*ptr >= parser->end || !is_alpha(**ptr))
     {
-        return unmatched(NULL);
+        return unmatched(parser, node);
     } // if
 
-    match_sequence(ptr, &node->data);
-    size_t len = 0;
-    while (is_alphanumeric(**ptr) || **ptr == '.' || **ptr == '_')
-    {
-        *ptr += 1;
-        len += 1;
-    } // while
+    size_t seq_len = 0;
+    match_sequence(ptr, parser->end, &seq_len);
+    at(parser, node)->data = seq_len;
+    char const* const tail = skip_identifier(*ptr, parser->end);
+    size_t const len = tail - *ptr;
+    *ptr = tail;
     if (len > 0)
     {
-        node->type = NODE_DESCRIPTION;
-        node->left = create(NODE_REFERENCE);
-        if (node->left == &ALLOCATION_ERROR)
+        at(parser, node)->type = HGVS_Node_description;
+        Index const ref = create(parser, HGVS_Node_reference, begin(parser, node));
+        if (ref == ALLOCATION_ERROR)
         {
-            return allocation_error(node);
+            return allocation_error(parser, node);
         } // if
-        node->left->ptr = node->ptr;
+        at(parser, node)->left = ref;
 
-        node->left->left = create(NODE_IDENTIFIER);
-        if (node->left->left == &ALLOCATION_ERROR)
+        Index const id = create(parser, HGVS_Node_identifier, begin(parser, node));
+        if (id == ALLOCATION_ERROR)
         {
-            return allocation_error(node);
+            return allocation_error(parser, node);
         } // if
-        node->left->left->ptr = node->ptr;
-        node->left->left->data = node->data + len;
+        at(parser, ref)->left = id;
+        at(parser, id)->data = seq_len + len;
 
-        if (match_char(ptr, '('))
+        if (match_char(ptr, parser->end, '('))
         {
-            Node* const probe = reference(ptr);
-            if (probe == NULL)
+            Index const probe = reference(parser, ptr);
+            if (probe == NONE)
             {
-                return error(node, NULL, *ptr, "expected a reference");
+                return error(parser, node, HGVS_Error_expected_reference, *ptr);
             } // if
-            if (is_error(probe))
+            if (is_error(parser, probe))
             {
-                return error(node, probe, node->ptr, "while matching a description");
+                return frame(parser, node, probe, begin(parser, node), "while matching a description");
             } // if
-            node->right = probe;
+            at(parser, node)->right = probe;
 
-            if (!match_char(ptr, ')'))
+            if (!match_char(ptr, parser->end, ')'))
             {
-                return error(node, NULL, *ptr, "expected: ')'");
+                return error(parser, node, HGVS_Error_expected_closing_parenthesis, *ptr);
             } // if
         } // if
 
-        if (!match_char(ptr, ':'))
+        if (!match_char(ptr, parser->end, ':'))
         {
-            return error(node, NULL, *ptr, "expected: ':'");
+            return error(parser, node, HGVS_Error_expected_colon, *ptr);
         } // if
 
-        node->data = 0;
-        if (match_alpha(ptr, &node->data))
+        size_t system = 0;
+        if (match_alpha(ptr, parser->end, &system))
         {
-            if (!match_char(ptr, '.'))
+            if (!match_char(ptr, parser->end, '.'))
             {
-                return error(node, NULL, *ptr, "expected a coordinate system");
+                return error(parser, node, HGVS_Error_expected_coordinate_system, *ptr);
             } // if
         } // if
+        at(parser, node)->data = system;
 
-        Node* const probe = allele(ptr);
-        if (probe == NULL)
+        Index const probe = allele(parser, ptr);
+        if (probe == NONE)
         {
-            return error(node, NULL, *ptr, "expected an allele");
+            return error(parser, node, HGVS_Error_expected_allele, *ptr);
         } // if
-        if (is_error(probe))
+        if (is_error(parser, probe))
         {
-            return error(node, probe, node->ptr, "while matching a description");
+            return frame(parser, node, probe, begin(parser, node), "while matching a description");
         } // if
-        node->right = probe;
+        at(parser, node)->right = probe;
 
         return node;
     } // if
 
-    if (node->data == 0)
+    if (seq_len == 0)
     {
-        return error(node, NULL, node->ptr, "expected a sequence or description");
+        return error(parser, node, HGVS_Error_expected_sequence_or_description, begin(parser, node));
     } // if
 
     return node;
 } // sequence_or_description
 
 
-static Node*
-location_or_length(char const** const ptr)
+static Index
+location_or_length(Parser* const parser, char const** const ptr)
 {
+    STAT_CALL(parser, location_or_length);
     char const* const err = *ptr;
-    Node* probe = length(ptr);
-    if (is_error(probe))
+    Index probe = length(parser, ptr);
+    if (is_error(parser, probe))
     {
         return probe;
     } // if
 
-    if (probe == NULL)
+    if (probe == NONE)
     {
-        probe = location(ptr);
-        if (is_error(probe))
+        probe = location(parser, ptr);
+        if (is_error(parser, probe))
         {
-            return error(NULL, probe, err, "while matching a location");
+            return frame(parser, NONE, probe, err, "while matching a location");
         } // if
     } // if
     return probe;
 } // location_or_length
 
 
-static Node*
-insert(char const** const ptr)
+static Index
+insert(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_INSERT);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, insert);
+    Index const node = create(parser, HGVS_Node_insert, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    Node* probe = sequence_or_description(ptr);
-    if (is_error(probe))
+    if (parser->depth == NESTING_LIMIT)
+    {
+        return error(parser, node, HGVS_Error_nesting_too_deep, *ptr);
+    } // if
+    parser->depth += 1;
+    Index probe = sequence_or_description(parser, ptr);
+    parser->depth -= 1;
+    if (is_error(parser, probe))
     {
-        return error(node, probe, node->ptr, "while matching an inserted part");
+        return frame(parser, node, probe, begin(parser, node), "while matching an inserted part");
     } // if
 
-    if (probe == NULL)
+    if (probe == NONE)
     {
-        probe = location_or_length(ptr);
-        if (probe == NULL)
+        probe = location_or_length(parser, ptr);
+        if (probe == NONE)
         {
-            return unmatched(node);
+            return unmatched(parser, node);
         } // if
-        if (is_error(probe))
+        if (is_error(parser, probe))
         {
-            return error(node, probe, node->ptr, "while matching an inserted part");
+            return frame(parser, node, probe, begin(parser, node), "while matching an inserted part");
         } // if
     } // if
-    node->left = probe;
+    at(parser, node)->left = probe;
 
-    if (match_string(ptr, "inv"))
+    if (match_string(ptr, parser->end, "inv"))
     {
-        node->data = NODE_INVERTED;
+        at(parser, node)->data = HGVS_NODE_INVERTED;
     } // if
 
-    probe = repeated(ptr);
+    probe = repeated(parser, ptr);
 
-    if (is_error(probe))
+    if (is_error(parser, probe))
     {
-        return error(node, probe, node->ptr, "while matching an inserted part");
+        return frame(parser, node, probe, begin(parser, node), "while matching an inserted part");
     } // if
-    node->right = probe;
+    at(parser, node)->right = probe;
 
-    if (match_string(ptr, "inv"))
+    if (match_string(ptr, parser->end, "inv"))
     {
-        node->data = NODE_INVERTED;
+        at(parser, node)->data = HGVS_NODE_INVERTED;
     } // if
 
     return node;
 } // insert
 
 
-static Node*
-inserted(char const** const ptr)
+static Index
+inserted(Parser* const parser, char const** const ptr)
 {
-    if (match_char(ptr, '['))
+    STAT_CALL(parser, inserted);
+    if (match_char(ptr, parser->end, '['))
     {
-        Node* const node = create(NODE_COMPOUND_INSERT);
-        if (node == &ALLOCATION_ERROR)
+        Index const node = create(parser, HGVS_Node_compound_insert, *ptr - 1);
+        if (node == ALLOCATION_ERROR)
         {
-            return allocation_error(NULL);
+            return allocation_error(parser, NONE);
         } // if
-        node->ptr = *ptr - 1;
 
-        Node* probe = insert(ptr);
-        if (probe == NULL)
+        size_t const base = parser->pending_count;
+        for (;;)
         {
-            return error(node, error(NULL, NULL, *ptr, "expected an inserted part"), node->ptr, "while matching a compound insertion");
-        } // if
-        if (is_error(probe))
-        {
-            return error(node, probe, node->ptr, "while matching a compound insertion");
-        } // if
-        node->left = probe;
-        node->data = 1;
-
-        Node* tmp = node;
-        while (match_char(ptr, ';'))
-        {
-            node->data += 1;
-            tmp->right = create(NODE_COMPOUND_INSERT);
-            if (tmp->right == &ALLOCATION_ERROR)
+            Index const probe = insert(parser, ptr);
+            if (probe == NONE)
             {
-                return allocation_error(node);
+                return frame(parser, node, error(parser, NONE, HGVS_Error_expected_inserted_part, *ptr), begin(parser, node), "while matching a compound insertion");
             } // if
-            tmp = tmp->right;
-
-            probe = insert(ptr);
-            if (probe == NULL)
+            if (is_error(parser, probe))
             {
-                return error(node, error(NULL, NULL, *ptr, "expected an inserted part"), node->ptr, "while matching a compound insertion");
+                return frame(parser, node, probe, begin(parser, node), "while matching a compound insertion");
             } // if
-            if (is_error(probe))
+            if (!pend(parser, probe))
             {
-                return error(node, probe, node->ptr, "while matching a compound insertion");
+                return allocation_error(parser, node);
             } // if
-            tmp->left = probe;
-        } // while
+            if (!match_char(ptr, parser->end, ';'))
+            {
+                break;
+            } // if
+        } // for
 
-        if (!match_char(ptr, ']'))
+        if (!match_char(ptr, parser->end, ']'))
         {
-            return error(node, error(NULL, NULL, *ptr, "expected: ']'"), node->ptr, "while matching a compound insertion");
+            return frame(parser, node, error(parser, NONE, HGVS_Error_expected_closing_bracket, *ptr), begin(parser, node), "while matching a compound insertion");
         } // if
 
-        return node;
+        return items(parser, node, base);
     } // if
 
-    return insert(ptr);
+    return insert(parser, ptr);
 } // inserted
 
 
-static Node*
-substitution(char const** const ptr)
+static Index
+substitution(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_SUBSTITUTION);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, substitution);
+    Index const node = create(parser, HGVS_Node_substitution, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    if (match_char(ptr, '>'))
+    if (match_char(ptr, parser->end, '>'))
     {
-        Node* const probe = inserted(ptr);
-        if (probe == NULL)
+        Index const probe = inserted(parser, ptr);
+        if (probe == NONE)
         {
-            return error(node, NULL, *ptr, "expected an inserted part");
+            return error(parser, node, HGVS_Error_expected_inserted_part, *ptr);
         } // if
-        if (is_error(probe))
+        if (is_error(parser, probe))
         {
-            return error(node, probe, node->ptr, "while matching a substitution");
+            return frame(parser, node, probe, begin(parser, node), "while matching a substitution");
         } // if
-        node->right = probe;
+        at(parser, node)->right = probe;
 
         return node;
     } // if
 
-    return unmatched(node);
+    return unmatched(parser, node);
 } // substitution
 
 
-static Node*
-insertion(char const** const ptr)
+static Index
+insertion(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_INSERTION);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, insertion);
+    Index const node = create(parser, HGVS_Node_insertion, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    if (match_string(ptr, "ins"))
+    if (match_string(ptr, parser->end, "ins"))
     {
-        Node* const probe = inserted(ptr);
-        if (probe == NULL)
+        Index const probe = inserted(parser, ptr);
+        if (probe == NONE)
         {
-            return error(node, NULL, *ptr, "expected an inserted part");
+            return error(parser, node, HGVS_Error_expected_inserted_part, *ptr);
         } // if
-        if (is_error(probe))
+        if (is_error(parser, probe))
         {
-            return error(node, probe, node->ptr, "while matching an insertion");
+            return frame(parser, node, probe, begin(parser, node), "while matching an insertion");
         } // if
-        node->left = probe;
+        at(parser, node)->left = probe;
 
         return node;
     } // if
 
-    *ptr = node->ptr;
-    return unmatched(node);
+    *ptr = begin(parser, node);
+    return unmatched(parser, node);
 } // insertion
 
 
-static Node*
-deletion_or_deletion_insertion(char const** const ptr)
+static Index
+deletion_or_deletion_insertion(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_DELETION);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, deletion_or_deletion_insertion);
+    Index const node = create(parser, HGVS_Node_deletion, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    if (match_string(ptr, "del"))
+    if (match_string(ptr, parser->end, "del"))
     {
-        Node* probe = NULL;
-        if (**ptr == '[')
+        Index probe = NONE;
+        if (*ptr < parser->end && **ptr == '[')
         {
-            probe = inserted(ptr);
+            probe = inserted(parser, ptr);
         } // if
         else
         {
-            probe = sequence_or_length(ptr);
+            probe = sequence_or_length(parser, ptr);
         } // else
-        if (is_error(probe))
+        if (is_error(parser, probe))
         {
-            return error(node, probe, node->ptr, "while matching a deletion");
+            return frame(parser, node, probe, begin(parser, node), "while matching a deletion");
         } // if
-        node->left = probe;
+        at(parser, node)->left = probe;
 
-        if (match_string(ptr, "ins"))
+        if (match_string(ptr, parser->end, "ins"))
         {
-            node->type = NODE_DELETION_INSERTION;
+            at(parser, node)->type = HGVS_Node_deletion_insertion;
 
-            probe = inserted(ptr);
-            if (probe == NULL)
+            probe = inserted(parser, ptr);
+            if (probe == NONE)
             {
-                return error(node, NULL, *ptr, "expected an inserted part");
+                return error(parser, node, HGVS_Error_expected_inserted_part, *ptr);
             } // if
-            if (is_error(probe))
+            if (is_error(parser, probe))
             {
-                return error(node, probe, node->ptr, "while matching a deletion/insertion");
+                return frame(parser, node, probe, begin(parser, node), "while matching a deletion/insertion");
             } // if
-            node->right = probe;
+            at(parser, node)->right = probe;
         } // if
 
         return node;
     } // if
 
-    *ptr = node->ptr;
-    return unmatched(node);
+    *ptr = begin(parser, node);
+    return unmatched(parser, node);
 } // deletion_or_deletion_insertion
 
 
-static Node*
-duplication(char const** const ptr)
+static Index
+duplication(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_DUPLICATION);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, duplication);
+    Index const node = create(parser, HGVS_Node_duplication, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    if (match_string(ptr, "dup"))
+    if (match_string(ptr, parser->end, "dup"))
     {
-        Node* const probe = inserted(ptr);
-        if (is_error(probe))
+        Index const probe = inserted(parser, ptr);
+        if (is_error(parser, probe))
         {
-            return error(node, probe, node->ptr, "while matching an duplication");
+            return frame(parser, node, probe, begin(parser, node), "while matching an duplication");
         } // if
-        node->left = probe;
+        at(parser, node)->left = probe;
 
         return node;
     } // if
 
-    *ptr = node->ptr;
-    return unmatched(node);
+    *ptr = begin(parser, node);
+    return unmatched(parser, node);
 } // duplication
 
 
-static Node*
-conversion(char const** const ptr)
+static Index
+conversion(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_CONVERSION);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, conversion);
+    Index const node = create(parser, HGVS_Node_conversion, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    if (match_string(ptr, "con"))
+    if (match_string(ptr, parser->end, "con"))
     {
-        Node* probe = inserted(ptr);
-        if (probe == NULL)
+        Index probe = inserted(parser, ptr);
+        if (probe == NONE)
         {
-            return error(node, NULL, *ptr, "expected an inserted part");
+            return error(parser, node, HGVS_Error_expected_inserted_part, *ptr);
         } // if
-        if (is_error(probe))
+        if (is_error(parser, probe))
         {
-            return error(node, probe, node->ptr, "while matching an conversion");
+            return frame(parser, node, probe, begin(parser, node), "while matching an conversion");
         } // if
-        node->left = probe;
+        at(parser, node)->left = probe;
 
         return node;
     } // if
-    return unmatched(node);
+
+    *ptr = begin(parser, node);
+    return unmatched(parser, node);
 } // conversion
 
 
-static Node*
-inversion(char const** const ptr)
+static Index
+inversion(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_INVERSION);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, inversion);
+    Index const node = create(parser, HGVS_Node_inversion, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    if (match_string(ptr, "inv"))
+    if (match_string(ptr, parser->end, "inv"))
     {
-        Node* const probe = inserted(ptr);
-        if (is_error(probe))
+        Index const probe = inserted(parser, ptr);
+        if (is_error(parser, probe))
         {
-            return error(node, probe, node->ptr, "while matching an inversion");
+            return frame(parser, node, probe, begin(parser, node), "while matching an inversion");
         } // if
-        node->left = probe;
+        at(parser, node)->left = probe;
 
         return node;
     } // if
 
-    *ptr = node->ptr;
-    return unmatched(node);
+    *ptr = begin(parser, node);
+    return unmatched(parser, node);
 } // inversion
 
 
-static Node*
-equal(char const** const ptr)
+static Index
+equal(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_EQUAL);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, equal);
+    Index const node = create(parser, HGVS_Node_equal, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    if (match_char(ptr, '='))
+    if (match_char(ptr, parser->end, '='))
     {
-        Node* const probe = inserted(ptr);
-        if (is_error(probe))
+        Index const probe = inserted(parser, ptr);
+        if (is_error(parser, probe))
         {
-            return error(node, probe, node->ptr, "while matching an equal");
+            return frame(parser, node, probe, begin(parser, node), "while matching an equal");
         } // if
-        node->left = probe;
+        at(parser, node)->left = probe;
 
         return node;
     } // if
 
-    *ptr = node->ptr;
-    return unmatched(node);
+    *ptr = begin(parser, node);
+    return unmatched(parser, node);
 } // equal
 
 
-static Node*
-variant(char const** const ptr)
+static Index
+variant(Parser* const parser, char const** const ptr)
 {
-    Node* const node = create(NODE_VARIANT);
-    if (node == &ALLOCATION_ERROR)
+    STAT_CALL(parser, variant);
+    Index const node = create(parser, HGVS_Node_variant, *ptr);
+    if (node == ALLOCATION_ERROR)
     {
-        return allocation_error(NULL);
+        return allocation_error(parser, NONE);
     } // if
-    node->ptr = *ptr;
 
-    Node* probe = location(ptr);
-    if (probe == NULL)
+    Index probe = location(parser, ptr);
+    if (probe == NONE)
     {
-        return error(node, error(NULL, NULL, *ptr, "expected a location"), node->ptr, "while matching a variant");
+        return frame(parser, node, error(parser, NONE, HGVS_Error_expected_location, *ptr), begin(parser, node), "while matching a variant");
     } // if
-    if (is_error(probe))
+    if (is_error(parser, probe))
     {
-        return error(node, probe, node->ptr, "while matching a variant");
+        return frame(parser, node, probe, begin(parser, node), "while matching a variant");
     } // if
-    node->left = probe;
+    at(parser, node)->left = probe;
 
-    probe = substitution(ptr);
-    if (is_error(probe))
-    {
-        return error(node, probe, node->ptr, "while matching a variant");
-    } // if
-    if (probe != NULL)
+    // The next character (for 'c', 'd' and 'i' the keyword) selects the
+    // only alternative that can match; once selected, it returns either
+    // a node or an error.
+    char const next = *ptr < parser->end ? **ptr : '\0';
+    probe = NONE;
+    switch (next)
     {
-        node->right = probe;
-        return node;
-    } // if
+        case '>':
+            probe = substitution(parser, ptr);
+            break;
+        case '=':
+            probe = equal(parser, ptr);
+            break;
+        case 'c':
+            if (peek_string(*ptr, parser->end, "con"))
+            {
+                probe = conversion(parser, ptr);
+            } // if
+            break;
+        case 'd':
+            if (peek_string(*ptr, parser->end, "del"))
+            {
+                probe = deletion_or_deletion_insertion(parser, ptr);
+            } // if
+            else if (peek_string(*ptr, parser->end, "dup"))
+            {
+                probe = duplication(parser, ptr);
+            } // if
+            break;
+        case 'i':
+            if (peek_string(*ptr, parser->end, "ins"))
+            {
+                probe = insertion(parser, ptr);
+            } // if
+            else if (peek_string(*ptr, parser->end, "inv"))
+            {
+                probe = inversion(parser, ptr);
+            } // if
+            break;
+    } // switch
 
-    probe = deletion_or_deletion_insertion(ptr);
-    if (is_error(probe))
-    {
-        return error(node, probe, node->ptr, "while matching a variant");
-    } // if
-    if (probe != NULL)
+    // any other nucleotide (also a 'c' or 'd' without keyword) starts a
+    // substitution or repeat
+    if (probe == NONE && is_IUPAC_NT(next))
     {
-        node->right = probe;
-        return node;
+        probe = substitution_or_repeat(parser, ptr);
     } // if
-
-    probe = insertion(ptr);
-    if (is_error(probe))
+    if (is_error(parser, probe))
     {
-        return error(node, probe, node->ptr, "while matching a variant");
+        return frame(parser, node, probe, begin(parser, node), "while matching a variant");
     } // if
-    if (probe != NULL)
+    if (probe != NONE)
     {
-        node->right = probe;
+        at(parser, node)->right = probe;
         return node;
     } // if
 
-    probe = duplication(ptr);
-    if (is_error(probe))
+    probe = repeated(parser, ptr);
+    if (is_error(parser, probe))
     {
-        return error(node, probe, node->ptr, "while matching a variant");
+        return frame(parser, node, probe, begin(parser, node), "while matching a variant");
     } // if
-    if (probe != NULL)
+    if (probe != NONE)
     {
-        node->right = probe;
-        return node;
-    } // if
+        at(parser, node)->type = HGVS_Node_repeat;
+        at(parser, node)->right = probe;
 
-    probe = inversion(ptr);
-    if (is_error(probe))
-    {
-        return error(node, probe, node->ptr, "while matching a variant");
-    } // if
-    if (probe != NULL)
-    {
-        node->right = probe;
-        return node;
+        probe = compound_repeat(parser, ptr, node);
+        if (is_error(parser, probe))
+        {
+            return frame(parser, node, probe, begin(parser, node), "while matching a variant");
+        } // if
+        return probe;
     } // if
 
-    probe = conversion(ptr);
-    if (is_error(probe))
-    {
-        return error(node, probe, node->ptr, "while matching a variant");
-    } // if
-    if (probe != NULL)
+    Index const slice = create(parser, HGVS_Node_slice, begin(parser, node));
+    if (slice == ALLOCATION_ERROR)
     {
-        node->right = probe;
-        return node;
+        return allocation_error(parser, node);
     } // if
+    at(parser, node)->right = slice;
 
-    probe = equal(ptr);
-    if (is_error(probe))
-    {
-        return error(node, probe, node->ptr, "while matching a variant");
-    } // if
-    if (probe != NULL)
-    {
-        node->right = probe;
-        return node;
-    } // if
+    return node;
+} // variant
 
-    probe = substitution_or_repeat(ptr);
-    if (is_error(probe))
-    {
-        return error(node, probe, node->ptr, "while matching a variant");
-    } // if
-    if (probe != NULL)
-    {
-        node->right = probe;
-        return node;
-    } // if
 
-    probe = repeated(ptr);
-    if (is_error(probe))
-    {
-        return error(node, probe, node->ptr, "while matching a variant");
-    } // if
-    if (probe != NULL)
+static Index
+allele(Parser* const parser, char const** const ptr)
+{
+    STAT_CALL(parser, allele);
+    if (match_char(ptr, parser->end, '['))
     {
-        node->type = NODE_REPEAT;
-        node->right = probe;
+        Index const node = create(parser, HGVS_Node_compound_variant, *ptr - 1);
+        if (node == ALLOCATION_ERROR)
+        {
+            return allocation_error(parser, NONE);
+        } // if
 
-        probe = compound_repeat(ptr);
-        if (is_error(probe))
+        if (match_char(ptr, parser->end, '='))
         {
-            return error(node, probe, node->ptr, "while matching a variant");
+            at(parser, node)->type = HGVS_Node_equal;
+            return node;
         } // if
 
-        if (probe != NULL)
+        size_t const base = parser->pending_count;
+        for (;;)
         {
-            Node* const new = create(NODE_COMPOUND_REPEAT);
-            if (new == &ALLOCATION_ERROR)
+            Index const probe = variant(parser, ptr);
+            if (is_error(parser, probe))
+            {
+                return frame(parser, node, probe, begin(parser, node), "while matching an allele");
+            } // if
+            if (!pend(parser, probe))
+            {
+                return allocation_error(parser, node);
+            } // if
+            if (!match_char(ptr, parser->end, ';'))
             {
-                destroy(probe);
-                return allocation_error(node);
+                break;
             } // if
-            node->ptr = *ptr;
-            new->left = node;
-            new->right = probe;
+        } // for
+
+        if (!match_char(ptr, parser->end, ']'))
+        {
+            return frame(parser, node, error(parser, NONE, HGVS_Error_expected_closing_bracket, *ptr), begin(parser, node), "while matching an allele");
+        } // if
+
+        return items(parser, node, base);
+    } // if
 
-            return new;
+    if (match_char(ptr, parser->end, '='))
+    {
+        Index const node = create(parser, HGVS_Node_equal, *ptr);
+        if (node == ALLOCATION_ERROR)
+        {
+            return allocation_error(parser, NONE);
         } // if
+
         return node;
     } // if
 
-    node->right = create(NODE_SLICE);
-    if (node->right == &ALLOCATION_ERROR)
+    return variant(parser, ptr);
+} // allele
+
+
+// print() and json() walk a tree with a stack of tasks instead of
+// recursing: the nodes still to visit and the text between them, last
+// first.
+enum Task_Kind
+{
+    TASK_NODE,
+    TASK_ITEMS,     // the elements of a compound from item on, each after str
+    TASK_ERROR,     // the line of an error
+    TASK_SYSTEM,    // restores the coordinate system of the outer description
+    TASK_CLOSE,     // the right child of an object in JSON and its end
+    TASK_OPERATOR,
+    TASK_KEYWORD,
+    TASK_CHAR,
+    TASK_STRING,    // JSON
+};
+
+
+typedef struct Task
+{
+    uint32_t    kind;   // enum Task_Kind
+    uint32_t    value;  // a node or a character
+    uint32_t    item;   // of a compound
+    char const* str;
+} Task;
+
+
+typedef struct Tasks
+{
+    size_t count;
+    Task   tasks[TASKS_LIMIT];
+} Tasks;
+
+
+// Only a tree that was not built by the parser (a bad frozen one) can
+// have more tasks pending; the rest of it is left out.
+static inline void
+push_item(Tasks* const          tasks,
+          enum Task_Kind const  kind,
+          uint32_t const        value,
+          uint32_t const        item,
+          char const* const     str)
+{
+    if (tasks->count < TASKS_LIMIT)
     {
-        return allocation_error(node);
+        Task const task = {
+            .kind  = kind,
+            .value = value,
+            .item  = item,
+            .str   = str
+        }; // task
+        tasks->tasks[tasks->count] = task;
+        tasks->count += 1;
     } // if
-    node->right->ptr = node->ptr;
+} // push_item
 
-    return node;
-} // variant
+
+static inline void
+push(Tasks* const tasks, enum Task_Kind const kind, uint32_t const value, char const* const str)
+{
+    push_item(tasks, kind, value, 0, str);
+} // push
+
+
+static inline Task
+pop(Tasks* const tasks)
+{
+    tasks->count -= 1;
+    return tasks->tasks[tasks->count];
+} // pop
+
+
+// Writes what comes before the first child of a node, pushes what comes
+// after it and moves on to it (to NONE for a leaf).
+static size_t
+print_node(HGVS_Output* const   output,
+           Parser const* const parser,
+           Tasks* const        tasks,
+           Index* const        next)
+{
+    Index const index = *next;
+    Node const* const node = at(parser, index);
+    *next = NONE;
+    switch ((enum HGVS_Node_Type) node->type)
+    {
+        case HGVS_Node_allocation_error:
+             return HGVS_output_error(output, 0, message(node));
+        case HGVS_Node_error:
+            push(tasks, TASK_ERROR, index, NULL);
+            *next = node->right;
+            return 0;
+        case HGVS_Node_error_context:
+            return 0;
+        case HGVS_Node_unknown:
+            return HGVS_output_operator(output, '?');
+        case HGVS_Node_number:
+            return HGVS_output_number(output, wide(node));
+        case HGVS_Node_sequence:
+            return HGVS_output_sequence(output, begin(parser, index), node->data);
+        case HGVS_Node_identifier:
+            return HGVS_output_string(output, begin(parser, index), node->data);
+        case HGVS_Node_reference:
+            if (node->right != NONE)
+            {
+                push(tasks, TASK_OPERATOR, ')', NULL);
+                push(tasks, TASK_NODE, node->right, NULL);
+                push(tasks, TASK_OPERATOR, '(', NULL);
+            } // if
+            *next = node->left;
+            return 0;
+        case HGVS_Node_description:
+            if (node->data != 0)
+            {
+                push(tasks, TASK_SYSTEM, output->system, NULL);
+                output->system = output->fmt == HGVS_Format_canonical ? node->data | 0x20 : node->data;
+                push(tasks, TASK_NODE, node->right, NULL);
+                push(tasks, TASK_OPERATOR, '.', NULL);
+                push(tasks, TASK_CHAR, output->system, NULL);
+            } // if
+            else
+            {
+                push(tasks, TASK_NODE, node->right, NULL);
+            } // else
+            push(tasks, TASK_OPERATOR, ':', NULL);
+            *next = node->left;
+            return 0;
+        case HGVS_Node_offset:
+            *next = node->left;
+            return HGVS_output_operator(output, node->data == HGVS_NODE_POSITIVE_OFFSET ? '+' : '-');
+        case HGVS_Node_point:
+            push(tasks, TASK_NODE, node->right, NULL);
+            *next = node->left;
+            if (node->data == HGVS_NODE_DOWNSTREAM)
+            {
+                return HGVS_output_operator(output, '*');
+            } // if
+            if (node->data == HGVS_NODE_UPSTREAM)
+            {
+                return HGVS_output_operator(output, '-');
+            } // if
+            return 0;
+        case HGVS_Node_uncertain_point:
+            push(tasks, TASK_OPERATOR, ')', NULL);
+            push(tasks, TASK_NODE, node->right, NULL);
+            push(tasks, TASK_OPERATOR, '_', NULL);
+            *next = node->left;
+            return HGVS_output_operator(output, '(');
+        case HGVS_Node_range:
+            push(tasks, TASK_NODE, node->right, NULL);
+            push(tasks, TASK_OPERATOR, '_', NULL);
+            *next = node->left;
+            return 0;
+        case HGVS_Node_length:
+            push(tasks, TASK_OPERATOR, ')', NULL);
+            *next = node->left;
+            return HGVS_output_operator(output, '(');
+        case HGVS_Node_insert:
+            if (node->data == HGVS_NODE_INVERTED)
+            {
+                push(tasks, TASK_KEYWORD, 0, "inv");
+            } // if
+            if (node->right != NONE)
+            {
+                push(tasks, TASK_OPERATOR, ']', NULL);
+                push(tasks, TASK_NODE, node->right, NULL);
+                push(tasks, TASK_OPERATOR, '[', NULL);
+            } // if
+            *next = node->left;
+            return 0;
+        case HGVS_Node_compound_insert:
+        case HGVS_Node_compound_variant:
+            push(tasks, TASK_OPERATOR, ']', NULL);
+            push_item(tasks, TASK_ITEMS, index, 1, ";");
+            *next = item(parser, node, 0);
+            return HGVS_output_operator(output, '[');
+        case HGVS_Node_substitution:
+            push(tasks, TASK_NODE, node->right, NULL);
+            push(tasks, TASK_KEYWORD, 0, ">");
+            *next = node->left;
+            return 0;
+        case HGVS_Node_repeat:
+            push(tasks, TASK_OPERATOR, ']', NULL);
+            push(tasks, TASK_NODE, node->right, NULL);
+            push(tasks, TASK_OPERATOR, '[', NULL);
+            *next = node->left;
+            return 0;
+        case HGVS_Node_compound_repeat:
+            push_item(tasks, TASK_ITEMS, index, 1, NULL);
+            *next = item(parser, node, 0);
+            return 0;
+        case HGVS_Node_deletion:
+            *next = node->left;
+            return HGVS_output_keyword(output, "del");
+        case HGVS_Node_deletion_insertion:
+            push(tasks, TASK_NODE, node->right, NULL);
+            push(tasks, TASK_KEYWORD, 0, "ins");
+            *next = node->left;
+            return HGVS_output_keyword(output, "del");
+        case HGVS_Node_insertion:
+            *next = node->left;
+            return HGVS_output_keyword(output, "ins");
+        case HGVS_Node_duplication:
+            *next = node->left;
+            return HGVS_output_keyword(output, "dup");
+        case HGVS_Node_conversion:
+            *next = node->left;
+            return HGVS_output_keyword(output, "con");
+        case HGVS_Node_inversion:
+            *next = node->left;
+            return HGVS_output_keyword(output, "inv");
+        case HGVS_Node_equal:
+            *next = node->left;
+            return HGVS_output_keyword(output, "=");
+        case HGVS_Node_slice:
+            return 0;
+        case HGVS_Node_variant:
+            push(tasks, TASK_NODE, node->right, NULL);
+            *next = node->left;
+            return 0;
+    } // switch
+    return 0;
+} // print_node
 
 
-static Node*
-allele(char const** const ptr)
+static size_t
+print(HGVS_Output* const   output,
+      Parser const* const parser,
+      Index const         root)
 {
-    if (match_char(ptr, '['))
+    Tasks tasks;
+    tasks.count = 0;
+
+    size_t res = 0;
+    Index index = root;
+    for (;;)
     {
-        Node* const node = create(NODE_COMPOUND_VARIANT);
-        if (node == &ALLOCATION_ERROR)
+        while (index != NONE)
         {
-            return allocation_error(NULL);
-        } // if
-        node->ptr = *ptr - 1;
-
-        if (match_char(ptr, '='))
+            res += print_node(output, parser, &tasks, &index);
+        } // while
+        if (tasks.count == 0)
         {
-            node->type = NODE_EQUAL;
-            return node;
+            return res;
         } // if
 
-        Node* probe = variant(ptr);
-        if (is_error(probe))
+        Task const task = pop(&tasks);
+        switch ((enum Task_Kind) task.kind)
         {
-            return error(node, probe, node->ptr, "while matching an allele");
-        } // if
-        node->left = probe;
-        node->data = 1;
+            case TASK_NODE:
+                index = task.value;
+                break;
+            case TASK_ITEMS:
+                if (task.item < at(parser, task.value)->data)
+                {
+                    push_item(&tasks, TASK_ITEMS, task.value, task.item + 1, task.str);
+                    index = item(parser, at(parser, task.value), task.item);
+                    if (task.str != NULL)
+                    {
+                        res += HGVS_output_operator(output, task.str[0]);
+                    } // if
+                } // if
+                break;
+            case TASK_ERROR:
+                res += HGVS_output_error(output, at(parser, task.value)->offset, message(at(parser, at(parser, task.value)->left)));
+                break;
+            case TASK_SYSTEM:
+                output->system = task.value;
+                break;
+            case TASK_OPERATOR:
+                res += HGVS_output_operator(output, task.value);
+                break;
+            case TASK_KEYWORD:
+                res += HGVS_output_keyword(output, task.str);
+                break;
+            case TASK_CHAR:
+                res += HGVS_output_char(output, task.value);
+                break;
+            default:
+                break;
+        } // switch
+    } // for
+} // print
 
-        Node* tmp = node;
-        while (match_char(ptr, ';'))
-        {
-            node->data += 1;
-            tmp->right = create(NODE_COMPOUND_VARIANT);
-            if (tmp->right == &ALLOCATION_ERROR)
+
+// The start of the object of a node in JSON and the keys (with their
+// separators) of its children, so each takes a single write.
+static struct
+{
+    char const* type;
+    char const* left;
+    char const* right;
+} const JSON_KEYS[] =
+{
+    [HGVS_Node_allocation_error]   = {"{\"type\":\"allocation_error\"", NULL, NULL},
+    [HGVS_Node_error]              = {"{\"type\":\"error\"", NULL, NULL},
+    [HGVS_Node_error_context]      = {"{\"type\":\"error_context\"", NULL, NULL},
+    [HGVS_Node_unknown]            = {"{\"type\":\"unknown\"", NULL, NULL},
+    [HGVS_Node_number]             = {"{\"type\":\"number\"", NULL, NULL},
+    [HGVS_Node_sequence]           = {"{\"type\":\"sequence\"", NULL, NULL},
+    [HGVS_Node_identifier]         = {"{\"type\":\"identifier\"", NULL, NULL},
+    [HGVS_Node_reference]          = {"{\"type\":\"reference\"", ",\"id\":", ",\"selector\":"},
+    [HGVS_Node_description]        = {"{\"type\":\"description\"", ",\"reference\":", ",\"allele\":"},
+    [HGVS_Node_offset]             = {"{\"type\":\"offset\"", ",\"value\":", NULL},
+    [HGVS_Node_point]              = {"{\"type\":\"point\"", ",\"position\":", ",\"offset\":"},
+    [HGVS_Node_uncertain_point]    = {"{\"type\":\"uncertain_point\"", ",\"start\":", ",\"end\":"},
+    [HGVS_Node_range]              = {"{\"type\":\"range\"", ",\"start\":", ",\"end\":"},
+    [HGVS_Node_length]             = {"{\"type\":\"length\"", ",\"length\":", NULL},
+    [HGVS_Node_insert]             = {"{\"type\":\"insert\"", ",\"inserted\":", ",\"repeat\":"},
+    [HGVS_Node_compound_insert]    = {"{\"type\":\"compound_insert\"", NULL, NULL},
+    [HGVS_Node_substitution]       = {"{\"type\":\"substitution\"", ",\"deleted\":", ",\"inserted\":"},
+    [HGVS_Node_repeat]             = {"{\"type\":\"repeat\"", ",\"unit\":", ",\"count\":"},
+    [HGVS_Node_compound_repeat]    = {"{\"type\":\"compound_repeat\"", NULL, NULL},
+    [HGVS_Node_deletion]           = {"{\"type\":\"deletion\"", ",\"deleted\":", NULL},
+    [HGVS_Node_deletion_insertion] = {"{\"type\":\"deletion_insertion\"", ",\"deleted\":", ",\"inserted\":"},
+    [HGVS_Node_insertion]          = {"{\"type\":\"insertion\"", ",\"inserted\":", NULL},
+    [HGVS_Node_duplication]        = {"{\"type\":\"duplication\"", ",\"duplicated\":", NULL},
+    [HGVS_Node_conversion]         = {"{\"type\":\"conversion\"", ",\"source\":", NULL},
+    [HGVS_Node_inversion]          = {"{\"type\":\"inversion\"", ",\"inverted\":", NULL},
+    [HGVS_Node_equal]              = {"{\"type\":\"equal\"", ",\"sequence\":", NULL},
+    [HGVS_Node_slice]              = {"{\"type\":\"slice\"", NULL, NULL},
+    [HGVS_Node_variant]            = {"{\"type\":\"variant\"", ",\"location\":", ",\"change\":"},
+    [HGVS_Node_compound_variant]   = {"{\"type\":\"compound_variant\"", NULL, NULL},
+};
+
+
+// Numbers, sequences and identifiers are JSON values; every other node
+// is an object with its type, its flags and its children by name (see
+// JSON_KEYS); compounds have their parts as "items".
+static inline bool
+json_value(HGVS_Output* const   output,
+           Parser const* const parser,
+           Index const         index,
+           size_t* const       res)
+{
+    Node const* const node = at(parser, index);
+    switch ((enum HGVS_Node_Type) node->type)
+    {
+        case HGVS_Node_number:
+            *res += HGVS_output_decimal(output, wide(node));
+            return true;
+        case HGVS_Node_sequence:
+        case HGVS_Node_identifier:
+            *res += HGVS_output_json_string(output, begin(parser, index), node->data);
+            return true;
+        default:
+            return false;
+    } // switch
+} // json_value
+
+
+// As print_node(); children that are values are written right away.
+static size_t
+json_node(HGVS_Output* const   output,
+          Parser const* const parser,
+          Tasks* const        tasks,
+          Index* const        next)
+{
+    Index const index = *next;
+    Node const* const node = at(parser, index);
+    *next = NONE;
+    size_t res = 0;
+    if (json_value(output, parser, index, &res))
+    {
+        return res;
+    } // if
+
+    res = HGVS_output_puts(output, JSON_KEYS[node->type].type);
+    switch ((enum HGVS_Node_Type) node->type)
+    {
+        case HGVS_Node_description:
+            if (node->data != 0)
             {
-                return allocation_error(node);
+                char const system = node->data;
+                res += HGVS_output_puts(output, ",\"system\":") +
+                       HGVS_output_json_string(output, &system, 1);
             } // if
-            tmp = tmp->right;
-            tmp->ptr = *ptr;
-
-            probe = variant(ptr);
-            if (is_error(probe))
+            break;
+        case HGVS_Node_offset:
+            res += HGVS_output_puts(output, node->data == HGVS_NODE_POSITIVE_OFFSET ? ",\"sign\":\"+\"" : ",\"sign\":\"-\"");
+            break;
+        case HGVS_Node_point:
+            if (node->data == HGVS_NODE_DOWNSTREAM)
             {
-                return error(node, probe, node->ptr, "while matching an allele");
+                res += HGVS_output_puts(output, ",\"anchor\":\"downstream\"");
             } // if
-            tmp->left = probe;
-        } // while
+            else if (node->data == HGVS_NODE_UPSTREAM)
+            {
+                res += HGVS_output_puts(output, ",\"anchor\":\"upstream\"");
+            } // if
+            break;
+        case HGVS_Node_insert:
+            if (node->data == HGVS_NODE_INVERTED)
+            {
+                res += HGVS_output_puts(output, ",\"inverted\":true");
+            } // if
+            break;
+        case HGVS_Node_compound_insert:
+        case HGVS_Node_compound_repeat:
+        case HGVS_Node_compound_variant:
+            push(tasks, TASK_STRING, 0, "]}");
+            push_item(tasks, TASK_ITEMS, index, 1, ",");
+            *next = item(parser, node, 0);
+            return res + HGVS_output_puts(output, ",\"items\":[");
+        default:
+            break;
+    } // switch
 
-        if (!match_char(ptr, ']'))
+    if (JSON_KEYS[node->type].left != NULL && node->left != NONE)
+    {
+        res += HGVS_output_puts(output, JSON_KEYS[node->type].left);
+        if (!json_value(output, parser, node->left, &res))
         {
-            return error(node, error(NULL, NULL, *ptr, "expected: ']'"), node->ptr, "while matching an allele");
+            push(tasks, TASK_CLOSE, index, NULL);
+            *next = node->left;
+            return res;
         } // if
-
-        return node;
     } // if
-
-    if (match_char(ptr, '='))
+    if (JSON_KEYS[node->type].right != NULL && node->right != NONE)
     {
-        Node* const node = create(NODE_EQUAL);
-        if (node == &ALLOCATION_ERROR)
+        res += HGVS_output_puts(output, JSON_KEYS[node->type].right);
+        if (!json_value(output, parser, node->right, &res))
         {
-            return allocation_error(NULL);
+            push(tasks, TASK_STRING, 0, "}");
+            *next = node->right;
+            return res;
         } // if
-        node->ptr = *ptr;
-
-        return node;
     } // if
+    return res + HGVS_output_putc(output, '}');
+} // json_node
 
-    return variant(ptr);
-} // allele
 
+static size_t
+json(HGVS_Output* const   output,
+     Parser const* const parser,
+     Index const         root)
+{
+    Tasks tasks;
+    tasks.count = 0;
 
-size_t
-print(FILE*                  stream,
-      enum HGVS_Format const fmt,
-      char const* const      str,
-      Node const* const      node)
-{
-    if (node != NULL)
-    {
-        Node const* tmp = NULL;
-        size_t res = 0;
-        switch (node->type)
-        {
-            case NODE_ALLOCATION_ERROR:
-                 return HGVS_fprintf_error(stream, fmt, 0, node->ptr);
-            case NODE_ERROR:
-                 return print(stream, fmt, str, node->right) +
-                        HGVS_fprintf_error(stream, fmt, node->ptr - str, node->left->ptr);
-            case NODE_ERROR_CONTEXT:
-                return 0;
-            case NODE_UNKNOWN:
-                return HGVS_fprintf_operator(stream, fmt, '?');
-            case NODE_NUMBER:
-                return HGVS_fprintf_number(stream, fmt, node->data);
-            case NODE_SEQUENCE:
-            case NODE_IDENTIFIER:
-                return HGVS_fprintf_string(stream, fmt, node->ptr, node->data);
-            case NODE_REFERENCE:
-                if (node->right != NULL)
-                {
-                    return print(stream, fmt, str, node->left) +
-                           HGVS_fprintf_operator(stream, fmt, '(') +
-                           print(stream, fmt, str, node->right) +
-                           HGVS_fprintf_operator(stream, fmt, ')');
-                } // if
-                return print(stream, fmt, str, node->left);
-            case NODE_DESCRIPTION:
-                if (node->data != 0)
-                {
-                    return print(stream, fmt, str, node->left) +
-                           HGVS_fprintf_operator(stream, fmt, ':') +
-                           HGVS_fprintf_char(stream, fmt, node->data) +
-                           HGVS_fprintf_operator(stream, fmt, '.') +
-                           print(stream, fmt, str, node->right);
-                } // if
-                return print(stream, fmt, str, node->left) +
-                       HGVS_fprintf_operator(stream, fmt, ':') +
-                       print(stream, fmt, str, node->right);
-            case NODE_OFFSET:
-                if (node->data == NODE_POSITIVE_OFFSET)
-                {
-                    return HGVS_fprintf_operator(stream, fmt, '+') +
-                           print(stream, fmt, str, node->left);
-                } // if
-                return HGVS_fprintf_operator(stream, fmt, '-') +
-                       print(stream, fmt, str, node->left);
-            case NODE_POINT:
-                if (node->data == NODE_DOWNSTREAM)
-                {
-                    return HGVS_fprintf_operator(stream, fmt, '*') +
-                           print(stream, fmt, str, node->left) +
-                           print(stream, fmt, str, node->right);
-                } // if
-                if (node->data == NODE_UPSTREAM)
-                {
-                    return HGVS_fprintf_operator(stream, fmt, '-') +
-                           print(stream, fmt, str, node->left) +
-                           print(stream, fmt, str, node->right);
-                } // if
-                return print(stream, fmt, str, node->left) +
-                       print(stream, fmt, str, node->right);
-            case NODE_UNCERTAIN_POINT:
-                return HGVS_fprintf_operator(stream, fmt, '(') +
-                       print(stream, fmt, str, node->left) +
-                       HGVS_fprintf_operator(stream,fmt, '_') +
-                       print(stream, fmt, str, node->right) +
-                       HGVS_fprintf_operator(stream, fmt, ')');
-            case NODE_RANGE:
-                return print(stream, fmt, str, node->left) +
-                       HGVS_fprintf_operator(stream, fmt, '_') +
-                       print(stream, fmt, str, node->right);
-            case NODE_LENGTH:
-                return HGVS_fprintf_operator(stream, fmt, '(') +
-                       print(stream, fmt, str, node->left) +
-                       HGVS_fprintf_operator(stream, fmt, ')');
-            case NODE_INSERT:
-                res = print(stream, fmt, str, node->left);
-                if (node->right != NULL)
+    size_t res = 0;
+    Index index = root;
+    for (;;)
+    {
+        while (index != NONE)
+        {
+            res += json_node(output, parser, &tasks, &index);
+        } // while
+        if (tasks.count == 0)
+        {
+            return res;
+        } // if
+
+        Task const task = pop(&tasks);
+        Node const* node = NULL;
+        switch ((enum Task_Kind) task.kind)
+        {
+            case TASK_NODE:
+                index = task.value;
+                break;
+            case TASK_ITEMS:
+                if (task.item < at(parser, task.value)->data)
                 {
-                    res += HGVS_fprintf_operator(stream, fmt, '[') +
-                           print(stream, fmt, str, node->right) +
-                           HGVS_fprintf_operator(stream, fmt, ']');
+                    push_item(&tasks, TASK_ITEMS, task.value, task.item + 1, task.str);
+                    index = item(parser, at(parser, task.value), task.item);
+                    res += HGVS_output_puts(output, task.str);
                 } // if
-                if (node->data == NODE_INVERTED)
+                break;
+            case TASK_CLOSE:
+                node = at(parser, task.value);
+                if (JSON_KEYS[node->type].right != NULL && node->right != NONE)
                 {
-                    res += HGVS_fprintf_keyword(stream, fmt, "inv");
+                    push(&tasks, TASK_STRING, 0, "}");
+                    index = node->right;
+                    res += HGVS_output_puts(output, JSON_KEYS[node->type].right);
                 } // if
-                return res;
-            case NODE_COMPOUND_INSERT:
-            case NODE_COMPOUND_VARIANT:
-                res = HGVS_fprintf_operator(stream, fmt, '[') +
-                      print(stream, fmt, str, node->left);
-                tmp = node->right;
-                while (tmp != NULL)
+                else
                 {
-                    res += HGVS_fprintf_operator(stream, fmt, ';') +
-                           print(stream, fmt, str, tmp->left);
-                    tmp = tmp->right;
-                } // while
-                return res + HGVS_fprintf_operator(stream, fmt, ']');
-            case NODE_SUBSTITUTION:
-                return print(stream, fmt, str, node->left) +
-                       HGVS_fprintf_keyword(stream, fmt, ">") +
-                       print(stream, fmt, str, node->right);
-            case NODE_REPEAT:
-                return print(stream, fmt, str, node->left) +
-                       HGVS_fprintf_operator(stream, fmt, '[') +
-                       print(stream, fmt, str, node->right) +
-                       HGVS_fprintf_operator(stream, fmt, ']');
-            case NODE_COMPOUND_REPEAT:
-                tmp = node;
-                res = 0;
-                while (tmp != NULL)
-                {
-                    res += print(stream, fmt, str, tmp->left);
-                    tmp = tmp->right;
-                } // while
-                return res;
-            case NODE_DELETION:
-                return HGVS_fprintf_keyword(stream, fmt, "del") +
-                       print(stream, fmt, str, node->left);
-            case NODE_DELETION_INSERTION:
-                return HGVS_fprintf_keyword(stream, fmt, "del") +
-                       print(stream, fmt, str, node->left) +
-                       HGVS_fprintf_keyword(stream, fmt, "ins") +
-                       print(stream, fmt, str, node->right);
-            case NODE_INSERTION:
-                return HGVS_fprintf_keyword(stream, fmt, "ins") +
-                       print(stream, fmt, str, node->left);
-            case NODE_DUPLICATION:
-                return HGVS_fprintf_keyword(stream, fmt, "dup") +
-                       print(stream, fmt, str, node->left);
-            case NODE_CONVERSION:
-                return HGVS_fprintf_keyword(stream, fmt, "con") +
-                       print(stream, fmt, str, node->left);
-            case NODE_INVERSION:
-                return HGVS_fprintf_keyword(stream, fmt, "inv") +
-                       print(stream, fmt, str, node->left);
-            case NODE_EQUAL:
-                return HGVS_fprintf_keyword(stream, fmt, "=") +
-                       print(stream, fmt, str, node->left);
-            case NODE_SLICE:
-                return 0;
-            case NODE_VARIANT:
-                return print(stream, fmt, str, node->left) +
-                       print(stream, fmt, str, node->right);
+                    res += HGVS_output_putc(output, '}');
+                } // else
+                break;
+            case TASK_STRING:
+                res += HGVS_output_puts(output, task.str);
+                break;
+            default:
+                break;
         } // switch
+    } // for
+} // json
+
+
+// the chain of errors, innermost first (as printed)
+static size_t
+json_errors(HGVS_Output* const   output,
+            Parser const* const parser,
+            Index const         root)
+{
+    Tasks tasks;
+    tasks.count = 0;
+    push(&tasks, TASK_ERROR, root, NULL);
+    for (Index index = root; is_error(parser, index) && is_error(parser, at(parser, index)->right); )
+    {
+        index = at(parser, index)->right;
+        push(&tasks, TASK_ERROR, index, NULL);
+    } // for
+
+    size_t res = 0;
+    while (tasks.count > 0)
+    {
+        Node const* const node = at(parser, pop(&tasks).value);
+        char const* const msg = node->type == HGVS_Node_error ? message(at(parser, node->left)) : message(node);
+        res += HGVS_output_puts(output, "{\"offset\":") +
+               HGVS_output_decimal(output, node->offset) +
+               HGVS_output_puts(output, ",\"message\":") +
+               HGVS_output_json_string(output, msg, strlen(msg)) +
+               HGVS_output_putc(output, '}');
+        if (tasks.count > 0)
+        {
+            res += HGVS_output_putc(output, ',');
+        } // if
+    } // while
+    return res;
+} // json_errors
+
+
+struct HGVS_Result
+{
+    Parser parser;
+
+    char const* str;
+    size_t      len;
+    Index       root;
+};
+
+
+HGVS_Result*
+HGVS_result_create(void)
+{
+    HGVS_Result* const result = malloc(sizeof(*result));
+    if (result == NULL)
+    {
+        return NULL;
     } // if
-    return 0;
-} // print
+    if (!parser_init(&result->parser))
+    {
+        free(result);
+        return NULL;
+    } // if
+    result->str = NULL;
+    result->len = 0;
+    result->root = NONE;
+    return result;
+} // HGVS_result_create
+
+
+void
+HGVS_result_destroy(HGVS_Result* const result)
+{
+    if (result != NULL)
+    {
+        parser_destroy(&result->parser);
+        free(result);
+    } // if
+} // HGVS_result_destroy
+
+
+void
+HGVS_result_trace(HGVS_Result* const result, bool const trace)
+{
+    result->parser.trace = trace;
+} // HGVS_result_trace
 
 
 int
-HGVS_parse(char const* const str)
+HGVS_result_parse(HGVS_Result* const result, char const* const str)
 {
+    return HGVS_result_parse_n(result, str, strlen(str));
+} // HGVS_result_parse
+
+
+static int
+parse(HGVS_Result* const result, char const* const str, size_t const len)
+{
+    Parser* const parser = &result->parser;
+    parser_reset(parser, str, len);
+    STAT(parser, parses);
+
+    result->str = str;
+    result->len = len;
+    at(parser, ERROR)->data = HGVS_Error_none;
+
+    // node offsets are 32 bits
+    if (len >= UINT32_MAX)
+    {
+        result->root = error(parser, NONE, HGVS_Error_input_too_long, str);
+        return 1;
+    } // if
+
     char const* ptr = str;
 
-    Node* node = description(&ptr);
-    if (*ptr != '\0' && !is_error(node))
+    Index node = description(parser, &ptr);
+    if (ptr != parser->end && !is_error(parser, node))
     {
-        node = error(node, error(NULL, NULL, ptr, "unmatched input"), str, "while matching a description");
+        node = frame(parser, node, error(parser, NONE, HGVS_Error_unmatched_input, ptr), str, "while matching a description");
     } // if
 
-    fprintf(stdout, "%s\n", str);
-    print(stdout, HGVS_Format_console, str, node);
-    fprintf(stdout, "\n");
+    result->root = node;
+
+    return HGVS_result_accepted(result) ? 0 : 1;
+} // parse
+
+
+int
+HGVS_result_parse_n(HGVS_Result* const result, char const* const str, size_t const len)
+{
+    return parse(result, str, len);
+} // HGVS_result_parse_n
+
 
-    if (node == NULL || is_error(node))
+int
+HGVS_result_recognize_n(HGVS_Result* const result, char const* const str, size_t const len)
+{
+    // node offsets are 31 bits
+    if (len >= VIRTUAL - 1)
     {
-        HGVS_fprintf_failed(stdout);
-        destroy(node);
-        return 1;
+        return parse(result, str, len);
+    } // if
+
+    Parser* const parser = &result->parser;
+    bool const trace = parser->trace;
+    parser->recognize = true;
+    parser->trace = false;
+
+    int const ret = parse(result, str, len);
+    parser->recognize = false;
+    parser->trace = trace;
+    return ret;
+} // HGVS_result_recognize_n
+
+
+// only accepted inputs: a rejected one has the error record as its root
+static inline bool
+recognized(HGVS_Result const* const result)
+{
+    return result->root >= VIRTUAL;
+} // recognized
+
+
+bool
+HGVS_result_accepted(HGVS_Result const* const result)
+{
+    return result->root != NONE &&
+           result->root != ALLOCATION_ERROR &&
+           !is_error(&result->parser, result->root);
+} // HGVS_result_accepted
+
+
+char const*
+HGVS_result_input(HGVS_Result const* const result)
+{
+    return result->str;
+} // HGVS_result_input
+
+
+size_t
+HGVS_result_input_length(HGVS_Result const* const result)
+{
+    return result->len;
+} // HGVS_result_input_length
+
+
+static HGVS_Node const*
+node_at(HGVS_Result const* const result, Index const index)
+{
+    return index == NONE || index >= VIRTUAL ? NULL : at(&result->parser, index);
+} // node_at
+
+
+static Index
+index_of(HGVS_Result const* const result, HGVS_Node const* const node)
+{
+    return node - result->parser.nodes;
+} // index_of
+
+
+HGVS_Node const*
+HGVS_result_root(HGVS_Result const* const result)
+{
+    return node_at(result, result->root);
+} // HGVS_result_root
+
+
+static Index
+innermost_error(Parser const* const parser, Index node)
+{
+    if (!is_error(parser, node))
+    {
+        return node;
     } // if
+    while (is_error(parser, at(parser, node)->right))
+    {
+        node = at(parser, node)->right;
+    } // while
+    return node;
+} // innermost_error
+
 
-    HGVS_fprintf_accept(stdout);
-    destroy(node);
+enum HGVS_Error
+HGVS_result_error(HGVS_Result const* const result)
+{
+    Index const node = innermost_error(&result->parser, result->root);
+    if (node == ALLOCATION_ERROR)
+    {
+        return HGVS_Error_allocation;
+    } // if
+    if (!is_error(&result->parser, node))
+    {
+        return HGVS_Error_none;
+    } // if
+    return at(&result->parser, node)->data;
+} // HGVS_result_error
+
+
+size_t
+HGVS_result_error_offset(HGVS_Result const* const result)
+{
+    Index const node = innermost_error(&result->parser, result->root);
+    if (!is_error(&result->parser, node))
+    {
+        return 0;
+    } // if
+    return at(&result->parser, node)->offset;
+} // HGVS_result_error_offset
+
+
+char const*
+HGVS_result_error_message(HGVS_Result const* const result)
+{
+    Index const node = innermost_error(&result->parser, result->root);
+    if (node == NONE || HGVS_result_accepted(result))
+    {
+        return NULL;
+    } // if
+    if (node == ALLOCATION_ERROR)
+    {
+        return message(at(&result->parser, node));
+    } // if
+    return message(at(&result->parser, at(&result->parser, node)->left));
+} // HGVS_result_error_message
+
+
+char const*
+HGVS_error_message(enum HGVS_Error const error)
+{
+    if ((size_t) error >= sizeof(ERROR_MESSAGES) / sizeof(ERROR_MESSAGES[0]))
+    {
+        return NULL;
+    } // if
+    return ERROR_MESSAGES[error];
+} // HGVS_error_message
+
+
+size_t
+HGVS_result_print(FILE*                    stream,
+                  enum HGVS_Format const   fmt,
+                  HGVS_Result const* const result)
+{
+    HGVS_Output output;
+    HGVS_output_init(&output, stream, fmt);
+    size_t const res = HGVS_result_write(&output, result);
+    HGVS_output_flush(&output);
+    HGVS_output_destroy(&output);
+    return res;
+} // HGVS_result_print
+
+
+// Without a tree, an accepted input is written as it is.
+static size_t
+write_recognized(HGVS_Output* const output, HGVS_Result const* const result)
+{
+    if (output->fmt != HGVS_Format_json)
+    {
+        return HGVS_output_write(output, result->str, result->len);
+    } // if
+    return HGVS_output_puts(output, "{\"input\":") +
+           HGVS_output_json_string(output, result->str, result->len) +
+           HGVS_output_puts(output, ",\"accepted\":true}");
+} // write_recognized
+
+
+size_t
+HGVS_result_write(HGVS_Output* const output, HGVS_Result const* const result)
+{
+    if (recognized(result))
+    {
+        return write_recognized(output, result);
+    } // if
+    if (output->fmt != HGVS_Format_json)
+    {
+        return print(output, &result->parser, result->root);
+    } // if
+
+    size_t res = HGVS_output_puts(output, "{\"input\":") +
+                 HGVS_output_json_string(output, result->str, result->len);
+    if (HGVS_result_accepted(result))
+    {
+        res += HGVS_output_puts(output, ",\"accepted\":true,\"root\":") +
+               json(output, &result->parser, result->root);
+    } // if
+    else
+    {
+        res += HGVS_output_puts(output, ",\"accepted\":false,\"errors\":[");
+        if (result->root != NONE)
+        {
+            res += json_errors(output, &result->parser, result->root);
+        } // if
+        res += HGVS_output_putc(output, ']');
+    } // else
+    return res + HGVS_output_putc(output, '}');
+} // HGVS_result_write
+
+
+size_t
+HGVS_result_canonical(HGVS_Result const* const result, char* const buf, size_t const size)
+{
+    if (!HGVS_result_accepted(result) || recognized(result))
+    {
+        if (size > 0)
+        {
+            buf[0] = '\0';
+        } // if
+        return 0;
+    } // if
+
+    HGVS_Output output;
+    HGVS_output_init_buffer(&output, buf, size > 0 ? size - 1 : 0, HGVS_Format_canonical);
+    print(&output, &result->parser, result->root);
+    if (size > 0)
+    {
+        buf[output.len] = '\0';
+    } // if
+    return HGVS_output_length(&output);
+} // HGVS_result_canonical
+
+
+// numbers and error messages keep their upper half in the right index
+static bool
+has_wide(Node const* const node)
+{
+    return node->type == HGVS_Node_number ||
+           node->type == HGVS_Node_error_context ||
+           node->type == HGVS_Node_allocation_error;
+} // has_wide
+
+
+enum HGVS_Node_Type
+HGVS_node_type(HGVS_Result const* const result, HGVS_Node const* const node)
+{
+    (void) result;
+    return node->type;
+} // HGVS_node_type
+
+
+// compounds keep their elements in item nodes (see ITEMS)
+static bool
+is_compound(Node const* const node)
+{
+    return node->type == HGVS_Node_compound_insert ||
+           node->type == HGVS_Node_compound_repeat ||
+           node->type == HGVS_Node_compound_variant;
+} // is_compound
+
+
+HGVS_Node const*
+HGVS_node_left(HGVS_Result const* const result, HGVS_Node const* const node)
+{
+    if (is_compound(node))
+    {
+        return NULL;
+    } // if
+    return node_at(result, node->left);
+} // HGVS_node_left
+
+
+HGVS_Node const*
+HGVS_node_right(HGVS_Result const* const result, HGVS_Node const* const node)
+{
+    if (has_wide(node))
+    {
+        return NULL;
+    } // if
+    return node_at(result, node->right);
+} // HGVS_node_right
+
+
+HGVS_Node const*
+HGVS_node_item(HGVS_Result const* const result, HGVS_Node const* const node, size_t const index)
+{
+    if (!is_compound(node) || index >= node->data)
+    {
+        return NULL;
+    } // if
+    return node_at(result, item(&result->parser, node, index));
+} // HGVS_node_item
+
+
+size_t
+HGVS_node_data(HGVS_Result const* const result, HGVS_Node const* const node)
+{
+    (void) result;
+    if (node->type == HGVS_Node_number)
+    {
+        return wide(node);
+    } // if
+    if (has_wide(node))
+    {
+        return 0;
+    } // if
+    return node->data;
+} // HGVS_node_data
+
+
+size_t
+HGVS_node_offset(HGVS_Result const* const result, HGVS_Node const* const node)
+{
+    (void) result;
+    if (node->type == HGVS_Node_allocation_error || node->type == HGVS_Node_error_context)
+    {
+        return 0;
+    } // if
+    return node->offset;
+} // HGVS_node_offset
+
+
+char const*
+HGVS_node_ptr(HGVS_Result const* const result, HGVS_Node const* const node)
+{
+    if (node->type == HGVS_Node_allocation_error || node->type == HGVS_Node_error_context)
+    {
+        return message(node);
+    } // if
+    return begin(&result->parser, index_of(result, node));
+} // HGVS_node_ptr
+
+
+// A frozen tree is the root and the nodes from the error record on.
+typedef struct Frozen
+{
+    uint32_t root;
+    uint32_t count;
+} Frozen;
+
+
+size_t
+HGVS_result_freeze(HGVS_Result const* const result, void* const buf, size_t const size)
+{
+    Parser const* const parser = &result->parser;
+    size_t const count = parser->count - ERROR;
+    size_t const len = sizeof(Frozen) + count * sizeof(Node);
+    if (buf != NULL && len <= size)
+    {
+        Frozen const frozen = {result->root, count};
+        memcpy(buf, &frozen, sizeof(frozen));
+        memcpy((char*) buf + sizeof(frozen), parser->nodes + ERROR, count * sizeof(Node));
+    } // if
+    return len;
+} // HGVS_result_freeze
+
+
+static inline bool
+is_child(Parser const* const parser, Index const index)
+{
+    return index < parser->count && index != SCRATCH;
+} // is_child
+
+
+// every child and every part of the input a node refers to exists (and
+// is not the scratch node), every compound has its item nodes and the
+// error record is intact; the record's message is the only one, as
+// messages are addresses the buffer cannot be trusted with
+static bool
+frozen_valid(Parser const* const parser, Index const root)
+{
+    size_t const len = parser->end - parser->start;
+    if (root >= parser->count || root == SCRATCH || parser->count < FIRST)
+    {
+        return false;
+    } // if
+    Node const* const record = at(parser, ERROR);
+    if (record->type != HGVS_Node_error || record->left != ERROR_CONTEXT || record->right != NONE ||
+        record->data >= sizeof(ERROR_MESSAGES) / sizeof(ERROR_MESSAGES[0]) ||
+        at(parser, ERROR_CONTEXT)->type != HGVS_Node_error_context || at(parser, ERROR_CONTEXT)->left != NONE)
+    {
+        return false;
+    } // if
+    for (size_t i = ERROR; i < parser->count; ++i)
+    {
+        Node const* const node = at(parser, i);
+        if (i != ERROR_CONTEXT &&
+            (node->type == HGVS_Node_error_context || node->type == HGVS_Node_allocation_error))
+        {
+            return false;
+        } // if
+        if (node->type == ITEMS)
+        {
+            if (!is_child(parser, node->left) || !is_child(parser, node->right) ||
+                !is_child(parser, node->offset) || !is_child(parser, node->data))
+            {
+                return false;
+            } // if
+            continue;
+        } // if
+        if (node->type > HGVS_Node_compound_variant || node->offset > len ||
+            !is_child(parser, node->left) || (!has_wide(node) && !is_child(parser, node->right)))
+        {
+            return false;
+        } // if
+        if ((node->type == HGVS_Node_sequence || node->type == HGVS_Node_identifier) &&
+            node->data > len - node->offset)
+        {
+            return false;
+        } // if
+        if (is_compound(node))
+        {
+            size_t const count = (node->data + ITEMS_PER_NODE - 1) / ITEMS_PER_NODE;
+            if (node->data == 0 || node->left < FIRST || count > parser->count - node->left)
+            {
+                return false;
+            } // if
+            for (size_t j = 0; j < count; ++j)
+            {
+                if (at(parser, node->left + j)->type != ITEMS)
+                {
+                    return false;
+                } // if
+            } // for
+        } // if
+    } // for
+    return true;
+} // frozen_valid
+
+
+// Walks the tree from the root as print() and json() do, with at most
+// one visit per node: a frozen tree whose node refers to itself or to
+// one of its ancestors would have them walk it forever. The elements of
+// the compounds still to visit are kept with those being matched.
+static bool
+frozen_acyclic(Parser* const parser, Index const root)
+{
+    size_t visits = 0;
+    parser->pending_count = 0;
+    bool res = pend(parser, root);
+    while (res && parser->pending_count > 0)
+    {
+        parser->pending_count -= 1;
+        Index const index = parser->pending[parser->pending_count];
+        if (index == NONE)
+        {
+            continue;
+        } // if
+        visits += 1;
+        if (visits > parser->count)
+        {
+            res = false;
+            break;
+        } // if
+
+        Node const* const node = at(parser, index);
+        if (is_compound(node))
+        {
+            for (size_t i = 0; i < node->data && res; ++i)
+            {
+                res = pend(parser, item(parser, node, i));
+            } // for
+            continue;
+        } // if
+        res = pend(parser, node->left) && (has_wide(node) || pend(parser, node->right));
+    } // while
+    parser->pending_count = 0;
+    return res;
+} // frozen_acyclic
+
+
+int
+HGVS_result_thaw(HGVS_Result* const result,
+                 char const* const  str,
+                 size_t const       len,
+                 void const* const  buf,
+                 size_t const       size)
+{
+    Frozen frozen;
+    if (size < sizeof(frozen) || len >= UINT32_MAX)
+    {
+        return -1;
+    } // if
+    memcpy(&frozen, buf, sizeof(frozen));
+    if (frozen.count > UINT32_MAX / 2 || size != sizeof(frozen) + frozen.count * sizeof(Node))
+    {
+        return -1;
+    } // if
+
+    Parser* const parser = &result->parser;
+    size_t const count = frozen.count + ERROR;
+    while (parser->capacity < count)
+    {
+        if (!parser_grow(parser))
+        {
+            return -1;
+        } // if
+    } // while
+    parser_reset(parser, str, len);
+    Node const record[] = {*at(parser, ERROR), *at(parser, ERROR_CONTEXT)};
+    memcpy(parser->nodes + ERROR, (char const*) buf + sizeof(frozen), frozen.count * sizeof(Node));
+    parser->count = count;
+
+    result->str = str;
+    result->len = len;
+    result->root = frozen.root;
+    if (!frozen_valid(parser, frozen.root) || !frozen_acyclic(parser, frozen.root))
+    {
+        memcpy(parser->nodes + ERROR, record, sizeof(record));
+        parser_reset(parser, str, len);
+        result->root = NONE;
+        return -1;
+    } // if
+    set_wide(at(parser, ERROR_CONTEXT), (uintptr_t) ERROR_MESSAGES[at(parser, ERROR)->data]);
+    return HGVS_result_accepted(result) ? 0 : 1;
+} // HGVS_result_thaw
+
+
+#if defined(STATS)
+// One counter, in total and per parse, after the res characters written
+// so far; as fprintf(), negative from the first error on.
+static int
+print_counter(FILE* const       stream,
+              int const         res,
+              char const* const name,
+              char const* const suffix,
+              size_t const      count,
+              double const      parses)
+{
+    if (res < 0)
+    {
+        return res;
+    } // if
+    int const len = fprintf(stream, "%s%s\t%zu\t%.2f\n", name, suffix, count, count / parses);
+    return len < 0 ? len : res + len;
+} // print_counter
+#endif
+
+
+int
+HGVS_result_print_stats(FILE* stream, HGVS_Result const* const result)
+{
+#if defined(STATS)
+    Stats const* const stats = &result->parser.stats;
+    double const parses = stats->parses > 0 ? stats->parses : 1;
+
+    int res = fprintf(stream, "parses\t%zu\n", stats->parses);
+    res = print_counter(stream, res, "nodes created", "", stats->created, parses);
+    res = print_counter(stream, res, "nodes destroyed", "", stats->destroyed, parses);
+    res = print_counter(stream, res, "unmatched", "", stats->unmatched, parses);
+    res = print_counter(stream, res, "errors", "", stats->errors, parses);
+    res = print_counter(stream, res, "error frames", "", stats->frames, parses);
+    for (size_t i = 0; i < PRODUCTION_COUNT; ++i)
+    {
+        res = print_counter(stream, res, PRODUCTION_NAMES[i], "()", stats->calls[i], parses);
+    } // for
+    for (size_t i = 0; i < LEXER_COUNT; ++i)
+    {
+        res = print_counter(stream, res, LEXER_NAMES[i], "()", stats->lexed[i], parses);
+        res = print_counter(stream, res, LEXER_NAMES[i], "() bytes", stats->scanned[i], parses);
+    } // for
+    return res < 0 ? -1 : res;
+#else
+    (void) stream;
+    (void) result;
     return 0;
+#endif
+} // HGVS_result_print_stats
+
+
+void
+HGVS_result_add_stats(HGVS_Result* const result, HGVS_Result const* const other)
+{
+#if defined(STATS)
+    Stats* const stats = &result->parser.stats;
+    Stats const* const add = &other->parser.stats;
+    stats->parses += add->parses;
+    stats->unmatched += add->unmatched;
+    stats->errors += add->errors;
+    stats->frames += add->frames;
+    stats->created += add->created;
+    stats->destroyed += add->destroyed;
+    for (size_t i = 0; i < PRODUCTION_COUNT; ++i)
+    {
+        stats->calls[i] += add->calls[i];
+    } // for
+    for (size_t i = 0; i < LEXER_COUNT; ++i)
+    {
+        stats->lexed[i] += add->lexed[i];
+        stats->scanned[i] += add->scanned[i];
+    } // for
+#else
+    (void) result;
+    (void) other;
+#endif
+} // HGVS_result_add_stats
+
+
+int
+HGVS_parse(char const* const str)
+{
+    HGVS_Result* const result = HGVS_result_create();
+
+    HGVS_Output output;
+    HGVS_output_init(&output, stdout, HGVS_Format_console);
+    HGVS_output_puts(&output, str);
+    HGVS_output_putc(&output, '\n');
+    if (result == NULL)
+    {
+        HGVS_output_error(&output, 0, ALLOCATION_ERROR_MESSAGE);
+        HGVS_output_putc(&output, '\n');
+        HGVS_output_failed(&output);
+        HGVS_output_flush(&output);
+        HGVS_output_destroy(&output);
+        return 1;
+    } // if
+
+    HGVS_result_trace(result, true);
+    int const ret = HGVS_result_parse(result, str);
+
+    HGVS_result_write(&output, result);
+    HGVS_output_putc(&output, '\n');
+
+    if (ret != 0)
+    {
+        HGVS_output_failed(&output);
+    } // if
+    else
+    {
+        HGVS_output_accept(&output);
+    } // else
+    HGVS_output_flush(&output);
+    HGVS_output_destroy(&output);
+
+    HGVS_result_destroy(result);
+    return ret;
 } // HGVS_parse
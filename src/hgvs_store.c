@@ -0,0 +1,561 @@
+#define _POSIX_C_SOURCE 200809L
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+#include "../include/hash.h"
+#include "../include/hgvs.h"
+
+
+static char const     MAGIC[8] = "HGVSSTOR";
+static uint32_t const FORMAT   = 3;  // of the records and frozen trees
+static size_t const   LIMIT    = UINT32_MAX;  // of inputs and trees
+
+
+// The file is mapped once for this many bytes, so it can grow without
+// moving the records (and the messages handed out); appends beyond it
+// are dropped.
+static uint64_t const RESERVE = UINT64_C(1) << 36;
+
+// New records are collected and written in blocks of about this size,
+// under one file lock.
+static size_t const BLOCK = 1 << 20;
+
+
+typedef struct Header
+{
+    char     magic[8];
+    uint32_t format;
+    uint32_t reserved;
+    char     version[16];  // of the parser; nodes may differ per version
+} Header;
+
+
+// A record is followed by the input, the error message with its NUL
+// and the frozen tree, and padded to a multiple of 8 bytes. The check
+// is the hash of the record after it, up to the padding.
+typedef struct Record
+{
+    uint64_t check;
+    uint64_t hash;  // of the input
+    uint32_t len;   // of the input
+    uint32_t message_len;
+    uint32_t size;  // of the frozen tree; 0 if rejected
+    uint32_t error_offset;
+    uint32_t accepted;
+    uint32_t reserved;
+} Record;
+
+
+// Records by offset in an open addressing table (linear probing) that
+// is at most half full; a hash of 0 marks an empty slot. The offset of
+// a record that is not written yet is tagged and relative to the block
+// of new records.
+static uint64_t const PENDING = UINT64_C(1) << 63;
+
+
+typedef struct Slot
+{
+    uint64_t hash;
+    uint64_t offset;
+} Slot;
+
+
+struct HGVS_Store
+{
+    pthread_mutex_t lock;
+
+    int   fd;
+    bool  writable;
+    bool  trees;
+    bool  appended;
+    char*  map;
+    size_t reserve;
+    size_t end;  // of the valid records indexed
+
+    char*  block;  // of new records
+    size_t len;
+    size_t size;
+
+    Slot*  slots;
+    size_t mask;  // the number of slots - 1
+    size_t count;
+
+    size_t hits;
+    size_t misses;
+};
+
+
+static uint64_t
+unpadded(Record const* const record)
+{
+    return sizeof(*record) + (uint64_t) record->len + record->message_len + 1 + record->size;
+} // unpadded
+
+
+static Record const*
+record_at(HGVS_Store const* const store, uint64_t const offset)
+{
+    if (offset & PENDING)
+    {
+        return (Record const*) (store->block + (offset & ~PENDING));
+    } // if
+    return (Record const*) (store->map + offset);
+} // record_at
+
+
+static char const*
+input(Record const* const record)
+{
+    return (char const*) (record + 1);
+} // input
+
+
+static char const*
+message(Record const* const record)
+{
+    return input(record) + record->len;
+} // message
+
+
+static char const*
+tree(Record const* const record)
+{
+    return message(record) + record->message_len + 1;
+} // tree
+
+
+static bool
+lock_file(int const fd, short const type)
+{
+    struct flock lock = {
+        .l_type   = type,
+        .l_whence = SEEK_SET,
+        .l_start  = 0,
+        .l_len    = 0
+    }; // lock
+    while (fcntl(fd, F_SETLKW, &lock) == -1)
+    {
+        if (errno != EINTR)
+        {
+            return false;
+        } // if
+    } // while
+    return true;
+} // lock_file
+
+
+// the slot of the input or NULL
+static Slot*
+find(HGVS_Store const* const store, uint64_t const key, char const* const str, size_t const len)
+{
+    for (size_t index = key & store->mask; store->slots[index].hash != 0; index = (index + 1) & store->mask)
+    {
+        Slot* const slot = &store->slots[index];
+        Record const* const record = record_at(store, slot->offset);
+        if (slot->hash == key && record->len == len && memcmp(input(record), str, len) == 0)
+        {
+            return slot;
+        } // if
+    } // for
+    return NULL;
+} // find
+
+
+static void
+insert(Slot* const slots, size_t const mask, uint64_t const key, uint64_t const offset)
+{
+    size_t index = key & mask;
+    while (slots[index].hash != 0)
+    {
+        index = (index + 1) & mask;
+    } // while
+    slots[index].hash = key;
+    slots[index].offset = offset;
+} // insert
+
+
+// Indexes the record at offset unless its input is indexed already
+// (with a tree if this one has one); a record that cannot be indexed is
+// only parsed again.
+static void
+add(HGVS_Store* const store, Record const* const record, uint64_t const offset)
+{
+    Slot* const slot = find(store, record->hash, input(record), record->len);
+    if (slot != NULL)
+    {
+        if (!(slot->offset & PENDING) && record_at(store, slot->offset)->size < record->size)
+        {
+            slot->offset = offset;
+        } // if
+        return;
+    } // if
+    if (2 * (store->count + 1) > store->mask + 1)
+    {
+        size_t const mask = 2 * store->mask + 1;
+        Slot* const slots = calloc(mask + 1, sizeof(*slots));
+        if (slots == NULL)
+        {
+            return;
+        } // if
+        for (size_t i = 0; i <= store->mask; ++i)
+        {
+            if (store->slots[i].hash != 0)
+            {
+                insert(slots, mask, store->slots[i].hash, store->slots[i].offset);
+            } // if
+        } // for
+        free(store->slots);
+        store->slots = slots;
+        store->mask = mask;
+    } // if
+    insert(store->slots, store->mask, record->hash, offset);
+    store->count += 1;
+} // add
+
+
+// Indexes the valid records from the end of the indexed ones up to size
+// (the current size of the file); stops at the first invalid one.
+static void
+scan(HGVS_Store* const store, uint64_t size)
+{
+    if (size > store->reserve)
+    {
+        size = store->reserve;
+    } // if
+    while (size > store->end && size - store->end >= sizeof(Record))
+    {
+        Record const* const record = (Record const*) (store->map + store->end);
+        uint64_t const len = unpadded(record);
+        uint64_t const total = (len + 7) & ~UINT64_C(7);
+        if (total > size - store->end || record->accepted > 1 ||
+            record->check != hash((char const*) record + sizeof(record->check), len - sizeof(record->check)) ||
+            message(record)[record->message_len] != '\0')
+        {
+            return;
+        } // if
+        add(store, record, store->end);
+        store->end += total;
+    } // while
+} // scan
+
+
+static bool
+valid_header(Header const* const header)
+{
+    return memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 && header->format == FORMAT &&
+           strncmp(header->version, HGVS_VERSION_STRING, sizeof(header->version)) == 0;
+} // valid_header
+
+
+HGVS_Store*
+HGVS_store_open(char const* const path, bool const trees)
+{
+    HGVS_Store* const store = calloc(1, sizeof(*store));
+    if (store == NULL)
+    {
+        return NULL;
+    } // if
+    store->trees = trees;
+    store->writable = true;
+    store->map = MAP_FAILED;
+    store->reserve = SIZE_MAX > UINT32_MAX ? RESERVE : SIZE_MAX / 4;
+    store->mask = 15;
+    store->slots = calloc(store->mask + 1, sizeof(*store->slots));
+    pthread_mutex_init(&store->lock, NULL);
+
+    store->fd = open(path, O_RDWR | O_CREAT, 0666);
+    if (store->fd == -1 && (errno == EACCES || errno == EROFS))
+    {
+        store->writable = false;
+        store->fd = open(path, O_RDONLY);
+    } // if
+    if (store->slots == NULL || store->fd == -1 || !lock_file(store->fd, store->writable ? F_WRLCK : F_RDLCK))
+    {
+        HGVS_store_close(store);
+        return NULL;
+    } // if
+
+    struct stat st;
+    bool ok = fstat(store->fd, &st) == 0;
+    if (ok && (size_t) st.st_size < sizeof(Header))
+    {
+        // new, or its creator died while writing the header; any other
+        // file is left alone
+        Header header = {
+            .format   = FORMAT,
+            .reserved = 0
+        }; // header
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        strncpy(header.version, HGVS_VERSION_STRING, sizeof(header.version));
+        char prefix[sizeof(header)];
+        ok = store->writable &&
+             pread(store->fd, prefix, st.st_size, 0) == st.st_size &&
+             memcmp(prefix, &header, st.st_size) == 0 &&
+             pwrite(store->fd, &header, sizeof(header), 0) == sizeof(header);
+        st.st_size = sizeof(header);
+    } // if
+    if (ok)
+    {
+        store->map = mmap(NULL, store->reserve, PROT_READ, MAP_SHARED, store->fd, 0);
+        ok = store->map != MAP_FAILED && valid_header((Header const*) store->map);
+    } // if
+    if (ok)
+    {
+        store->end = sizeof(Header);
+        scan(store, st.st_size);
+        if (store->writable && store->end < (uint64_t) st.st_size)
+        {
+            ok = ftruncate(store->fd, store->end) == 0;
+        } // if
+    } // if
+    lock_file(store->fd, F_UNLCK);
+
+    if (!ok)
+    {
+        HGVS_store_close(store);
+        return NULL;
+    } // if
+    return store;
+} // HGVS_store_open
+
+
+// Writes the new records after the last valid record in the file,
+// first indexing those added by other processes. The mutex is held. On
+// failure the store is used read-only from then on (the new records are
+// kept, as they are still indexed).
+static void
+flush(HGVS_Store* const store)
+{
+    if (store->len == 0 || !store->writable)
+    {
+        return;
+    } // if
+    if (!lock_file(store->fd, F_WRLCK))
+    {
+        store->writable = false;
+        return;
+    } // if
+
+    struct stat st;
+    bool ok = fstat(store->fd, &st) == 0;
+    if (ok)
+    {
+        scan(store, st.st_size);
+        ok = store->len <= store->reserve - store->end &&
+             (store->end == (uint64_t) st.st_size || ftruncate(store->fd, store->end) == 0);
+    } // if
+    size_t done = 0;
+    while (ok && done < store->len)
+    {
+        ssize_t const len = pwrite(store->fd, store->block + done, store->len - done, store->end + done);
+        if (len > 0)
+        {
+            done += len;
+        } // if
+        else if (errno != EINTR)
+        {
+            ok = false;
+        } // if
+    } // while
+
+    if (ok)
+    {
+        for (size_t pos = 0; pos < store->len;)
+        {
+            Record const* const record = (Record const*) (store->block + pos);
+            Slot* const slot = find(store, record->hash, input(record), record->len);
+            if (slot != NULL && slot->offset == (PENDING | pos))
+            {
+                slot->offset = store->end + pos;
+            } // if
+            pos += (unpadded(record) + 7) & ~UINT64_C(7);
+        } // for
+        store->end += store->len;
+        store->len = 0;
+        store->appended = true;
+    } // if
+    else
+    {
+        if (done > 0)
+        {
+            ftruncate(store->fd, store->end);
+        } // if
+        store->writable = false;
+    } // else
+    lock_file(store->fd, F_UNLCK);
+} // flush
+
+
+void
+HGVS_store_close(HGVS_Store* const store)
+{
+    if (store == NULL)
+    {
+        return;
+    } // if
+    if (store->fd != -1)
+    {
+        flush(store);
+        if (store->appended)
+        {
+            fsync(store->fd);
+        } // if
+        close(store->fd);
+    } // if
+    if (store->map != MAP_FAILED)
+    {
+        munmap(store->map, store->reserve);
+    } // if
+    pthread_mutex_destroy(&store->lock);
+    free(store->block);
+    free(store->slots);
+    free(store);
+} // HGVS_store_close
+
+
+// Adds the verdict (and tree) of the input to the new records, unless
+// it is there already.
+static void
+append(HGVS_Store* const         store,
+       HGVS_Result const* const  result,
+       uint64_t const            key,
+       HGVS_Verdict const* const verdict)
+{
+    char const* const str = HGVS_result_input(result);
+    size_t const len = HGVS_result_input_length(result);
+    Record record = {
+        .check        = 0,
+        .hash         = key,
+        .len          = len,
+        .message_len  = verdict->accepted ? 0 : strlen(verdict->error_message),
+        .size         = 0,
+        .error_offset = verdict->error_offset,
+        .accepted     = verdict->accepted,
+        .reserved     = 0
+    }; // record
+    size_t const size = store->trees && verdict->accepted ? HGVS_result_freeze(result, NULL, 0) : 0;
+    if (size >= LIMIT - len)
+    {
+        return;
+    } // if
+    record.size = size;
+    size_t const total = (unpadded(&record) + 7) & ~UINT64_C(7);
+
+    pthread_mutex_lock(&store->lock);
+    Slot const* const slot = find(store, key, str, len);
+    if (!store->writable || (slot != NULL && ((slot->offset & PENDING) || record_at(store, slot->offset)->size >= size)))
+    {
+        pthread_mutex_unlock(&store->lock);
+        return;
+    } // if
+    if (store->len + total > store->size)
+    {
+        size_t const block = store->len + total > BLOCK ? store->len + total : BLOCK;
+        char* const data = realloc(store->block, block);
+        if (data == NULL)
+        {
+            pthread_mutex_unlock(&store->lock);
+            return;
+        } // if
+        store->block = data;
+        store->size = block;
+    } // if
+
+    char* const ptr = store->block + store->len;
+    memset(ptr, 0, total);
+    memcpy(ptr + sizeof(record), str, len);
+    if (!verdict->accepted)
+    {
+        memcpy(ptr + sizeof(record) + len, verdict->error_message, record.message_len);
+    } // if
+    HGVS_result_freeze(result, ptr + sizeof(record) + len + record.message_len + 1, size);
+    memcpy(ptr, &record, sizeof(record));
+    record.check = hash(ptr + sizeof(record.check), unpadded(&record) - sizeof(record.check));
+    memcpy(ptr, &record, sizeof(record));
+    add(store, (Record const*) ptr, PENDING | store->len);
+    store->len += total;
+    if (store->len >= BLOCK)
+    {
+        flush(store);
+    } // if
+    pthread_mutex_unlock(&store->lock);
+} // append
+
+
+int
+HGVS_store_parse_n(HGVS_Store* const   store,
+                   HGVS_Result* const  result,
+                   char const* const   str,
+                   size_t const        len,
+                   HGVS_Verdict* const verdict)
+{
+    uint64_t const key = len < LIMIT ? hash(str, len) : 0;
+    if (key != 0)
+    {
+        pthread_mutex_lock(&store->lock);
+        Slot const* const slot = find(store, key, str, len);
+        if (slot != NULL && !(slot->offset & PENDING))
+        {
+            Record const* const record = record_at(store, slot->offset);
+            verdict->accepted = record->accepted;
+            // a tree must give the record's verdict too
+            verdict->tree = store->trees && record->size > 0 &&
+                            HGVS_result_thaw(result, str, len, tree(record), record->size) == (record->accepted ? 0 : 1);
+            verdict->error_offset = record->error_offset;
+            verdict->error_message = record->accepted ? NULL : message(record);
+            if (verdict->tree || !store->trees)
+            {
+                store->hits += 1;
+                pthread_mutex_unlock(&store->lock);
+                return verdict->accepted ? 0 : 1;
+            } // if
+        } // if
+        store->misses += 1;
+        pthread_mutex_unlock(&store->lock);
+    } // if
+
+    int const ret = store->trees ? HGVS_result_parse_n(result, str, len)
+                                 : HGVS_result_recognize_n(result, str, len);
+    verdict->accepted = HGVS_result_accepted(result);
+    verdict->tree = store->trees;
+    verdict->error_offset = HGVS_result_error_offset(result);
+    verdict->error_message = HGVS_result_error_message(result);
+    HGVS_Node const* const root = HGVS_result_root(result);
+    if (key != 0 && (root == NULL || HGVS_node_type(result, root) != HGVS_Node_allocation_error))
+    {
+        append(store, result, key, verdict);
+    } // if
+    return ret;
+} // HGVS_store_parse_n
+
+
+size_t
+HGVS_store_hits(HGVS_Store* const store)
+{
+    pthread_mutex_lock(&store->lock);
+    size_t const res = store->hits;
+    pthread_mutex_unlock(&store->lock);
+    return res;
+} // HGVS_store_hits
+
+
+size_t
+HGVS_store_misses(HGVS_Store* const store)
+{
+    pthread_mutex_lock(&store->lock);
+    size_t const res = store->misses;
+    pthread_mutex_unlock(&store->lock);
+    return res;
+} // HGVS_store_misses
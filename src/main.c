@@ -1,17 +1,794 @@
+#define _POSIX_C_SOURCE 200809L
+
+
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 
 #include "../include/hgvs.h"
 
 
+static size_t const BATCH_BLOCK_SIZE  = 1 << 16;
+static size_t const BATCH_CHUNK_LINES = 4096;
+
+
+typedef struct Buffer
+{
+    char*  data;
+    size_t len;
+    size_t size;
+} Buffer;
+
+
+// what is written per line and how lines are parsed
+typedef struct Options
+{
+    enum HGVS_Format fmt;
+    bool             canonical;
+    HGVS_Cache*      cache;
+    HGVS_Store*      store;
+    HGVS_Result*     stats;  // with --stats, the counters of all parsers
+} Options;
+
+
+typedef struct Reader
+{
+    char** files;
+    int    count;
+    int    index;
+    FILE*  stream;
+
+    Buffer block;
+    size_t pos;
+    size_t chunk_lines;
+    bool   error;
+} Reader;
+
+
+typedef struct Chunk
+{
+    enum
+    {
+        CHUNK_FREE,
+        CHUNK_FILLED,
+        CHUNK_PARSING,
+        CHUNK_DONE,
+    } state;
+
+    Buffer      input;
+    HGVS_Output output;
+
+    size_t lines;
+    size_t failed;
+    bool   error;
+} Chunk;
+
+
+typedef struct Pipeline
+{
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+
+    Chunk* chunks;
+    size_t count;
+
+    size_t filled;
+    size_t claimed;
+    bool   eof;
+
+    size_t lines;
+    size_t failed;
+    bool   error;
+
+    Options const* options;
+} Pipeline;
+
+
+static void
+usage(char const* const name)
+{
+    fprintf(stderr, "Usage: %s string\n"
+                    "       %s -b [-n | -j] [-m entries | -p file] [-t threads] [-c lines] [--stats] [file ...]\n"
+                    "\n"
+                    "  -b  batch mode: parse the first field of every line of the\n"
+                    "      files (or stdin if none or '-' is given) and write one\n"
+                    "      tab-separated verdict per line, in input order:\n"
+                    "          accepted<TAB>description\n"
+                    "          failed<TAB>description<TAB>offset<TAB>message\n"
+                    "  -n  add the canonical form to every accepted description:\n"
+                    "          accepted<TAB>description<TAB>canonical\n"
+                    "  -j  write one JSON object per line instead (JSON Lines)\n"
+                    "  -m  cache the verdicts (and trees) of up to this many\n"
+                    "      distinct descriptions; hits and misses go to stderr\n"
+                    "  -p  as -m, but keep the verdicts (and trees) of all\n"
+                    "      descriptions in this file, across runs\n"
+                    "  -t  number of parser threads (default: online processors)\n"
+                    "  -c  number of lines per chunk of work (default: %zu)\n"
+                    "  --stats  write the counters of the parser to stderr (if\n"
+                    "      built with make OPTIONS='STATS')\n",
+                    name, name, BATCH_CHUNK_LINES);
+} // usage
+
+
+static bool
+buffer_reserve(Buffer* const buffer, size_t const len)
+{
+    if (buffer->len + len <= buffer->size)
+    {
+        return true;
+    } // if
+
+    size_t size = buffer->size > 0 ? buffer->size : BATCH_BLOCK_SIZE;
+    while (size < buffer->len + len)
+    {
+        size *= 2;
+    } // while
+    // one extra byte so the last line can always be terminated in place
+    char* const data = realloc(buffer->data, size + 1);
+    if (data == NULL)
+    {
+        return false;
+    } // if
+    buffer->data = data;
+    buffer->size = size;
+    return true;
+} // buffer_reserve
+
+
+static bool
+buffer_append(Buffer* const buffer, char const* const ptr, size_t const len)
+{
+    if (len == 0)
+    {
+        return true;
+    } // if
+    if (!buffer_reserve(buffer, len))
+    {
+        return false;
+    } // if
+    memcpy(buffer->data + buffer->len, ptr, len);
+    buffer->len += len;
+    return true;
+} // buffer_append
+
+
+static size_t
+output_failed(HGVS_Output* const        output,
+              char const* const         str,
+              size_t const              len,
+              HGVS_Verdict const* const verdict)
+{
+    return HGVS_output_puts(output, "failed\t") +
+           HGVS_output_write(output, str, len) +
+           HGVS_output_putc(output, '\t') +
+           HGVS_output_decimal(output, verdict->error_offset) +
+           HGVS_output_putc(output, '\t') +
+           HGVS_output_puts(output, verdict->error_message) +
+           HGVS_output_putc(output, '\n');
+} // output_failed
+
+
+static size_t
+output_canonical(HGVS_Output* const output, HGVS_Result const* const result)
+{
+    size_t const len = HGVS_result_canonical(result, NULL, 0);
+    char* const dst = HGVS_output_reserve(output, len + 1);
+    if (dst == NULL)
+    {
+        return 0;
+    } // if
+    output->len += HGVS_result_canonical(result, dst, len + 1);
+    return len;
+} // output_canonical
+
+
+static void
+buffer_destroy(Buffer* const buffer)
+{
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->len = 0;
+    buffer->size = 0;
+} // buffer_destroy
+
+
+// Counts up to max complete lines in [ptr, end) and moves *cut past the
+// last one.
+static size_t
+count_lines(char const* ptr, char const* const end, size_t const max, size_t* const cut, char const* const base)
+{
+    size_t lines = 0;
+    while (lines < max && ptr < end)
+    {
+        char const* const eol = memchr(ptr, '\n', end - ptr);
+        if (eol == NULL)
+        {
+            break;
+        } // if
+        lines += 1;
+        ptr = eol + 1;
+        *cut = ptr - base;
+    } // while
+    return lines;
+} // count_lines
+
+
+// Moves up to chunk_lines complete lines from the read block into the
+// chunk. Returns false when all input is consumed.
+static bool
+read_chunk(Reader* const reader, Chunk* const chunk)
+{
+    Buffer* const block = &reader->block;
+    chunk->input.len = 0;
+
+    size_t lines = 0;
+    for (;;)
+    {
+        size_t cut = reader->pos;
+        lines += count_lines(block->data + reader->pos, block->data + block->len, reader->chunk_lines - lines, &cut, block->data);
+        if (!buffer_append(&chunk->input, block->data + reader->pos, cut - reader->pos))
+        {
+            reader->error = true;
+            return false;
+        } // if
+        reader->pos = cut;
+        if (lines == reader->chunk_lines)
+        {
+            break;
+        } // if
+
+        // only a partial line is left: keep it and read more (an empty
+        // block has no data yet)
+        if (reader->pos > 0)
+        {
+            memmove(block->data, block->data + reader->pos, block->len - reader->pos);
+            block->len -= reader->pos;
+            reader->pos = 0;
+        } // if
+
+        if (reader->stream == NULL)
+        {
+            if (reader->index >= reader->count)
+            {
+                break;
+            } // if
+            char const* const name = reader->files[reader->index];
+            reader->stream = strcmp(name, "-") == 0 ? stdin : fopen(name, "rb");
+            if (reader->stream == NULL)
+            {
+                perror(name);
+                reader->error = true;
+                return false;
+            } // if
+        } // if
+
+        if (!buffer_reserve(block, BATCH_BLOCK_SIZE))
+        {
+            reader->error = true;
+            return false;
+        } // if
+        size_t const count = fread(block->data + block->len, 1, block->size - block->len, reader->stream);
+        block->len += count;
+
+        if (count == 0)
+        {
+            if (ferror(reader->stream))
+            {
+                perror(reader->files[reader->index]);
+                reader->error = true;
+            } // if
+            if (reader->stream != stdin)
+            {
+                fclose(reader->stream);
+            } // if
+            reader->stream = NULL;
+            reader->index += 1;
+            if (reader->error)
+            {
+                return false;
+            } // if
+
+            // a file without a trailing newline still ends its last line
+            if (block->len > 0)
+            {
+                block->data[block->len] = '\n';
+                block->len += 1;
+            } // if
+        } // if
+    } // for
+
+    chunk->lines = lines;
+    return lines > 0;
+} // read_chunk
+
+
+static void
+parse_chunk(HGVS_Result* const result, Chunk* const chunk, Options const* const options)
+{
+    HGVS_Output* const output = &chunk->output;
+    output->fmt = options->fmt;
+    output->len = 0;
+    chunk->failed = 0;
+    chunk->error = false;
+
+    // JSON lists every error of a rejected input
+    HGVS_result_trace(result, options->fmt == HGVS_Format_json);
+
+    char const* line = chunk->input.data;
+    char const* const end = chunk->input.data + chunk->input.len;
+    while (line < end)
+    {
+        char const* const eol = memchr(line, '\n', end - line);
+
+        char const* str = line;
+        while (str < eol && (*str == ' ' || *str == '\t'))
+        {
+            str += 1;
+        } // while
+        char const* tok = str;
+        while (tok < eol && *tok != ' ' && *tok != '\t' && *tok != '\r')
+        {
+            tok += 1;
+        } // while
+        line = eol + 1;
+
+        // only JSON and canonical forms need the tree, otherwise inputs
+        // are only recognized; a cache for them keeps trees, so the
+        // result is always complete then
+        HGVS_Verdict verdict;
+        if (options->store != NULL)
+        {
+            HGVS_store_parse_n(options->store, result, str, tok - str, &verdict);
+        } // if
+        else if (options->cache != NULL)
+        {
+            HGVS_cache_parse_n(options->cache, result, str, tok - str, &verdict);
+        } // if
+        else
+        {
+            if (options->fmt == HGVS_Format_json || options->canonical)
+            {
+                HGVS_result_parse_n(result, str, tok - str);
+            } // if
+            else
+            {
+                HGVS_result_recognize_n(result, str, tok - str);
+            } // else
+            verdict.accepted = HGVS_result_accepted(result);
+            verdict.error_offset = HGVS_result_error_offset(result);
+            verdict.error_message = HGVS_result_error_message(result);
+        } // else
+
+        if (!verdict.accepted)
+        {
+            chunk->failed += 1;
+        } // if
+        if (options->fmt == HGVS_Format_json)
+        {
+            HGVS_result_write(output, result);
+            HGVS_output_putc(output, '\n');
+        } // if
+        else if (verdict.accepted)
+        {
+            HGVS_output_write(output, "accepted\t", 9);
+            HGVS_output_write(output, str, tok - str);
+            if (options->canonical)
+            {
+                HGVS_output_putc(output, '\t');
+                output_canonical(output, result);
+            } // if
+            HGVS_output_putc(output, '\n');
+        } // if
+        else
+        {
+            output_failed(output, str, tok - str, &verdict);
+        } // else
+        if (output->error)
+        {
+            chunk->error = true;
+            return;
+        } // if
+    } // while
+} // parse_chunk
+
+
+static bool
+write_chunk(Chunk const* const chunk)
+{
+    if (chunk->error)
+    {
+        fprintf(stderr, "allocation error; out of memory?\n");
+        return false;
+    } // if
+    return fwrite(chunk->output.data, 1, chunk->output.len, stdout) == chunk->output.len;
+} // write_chunk
+
+
+static void*
+worker(void* const arg)
+{
+    Pipeline* const pipeline = arg;
+    HGVS_Result* const result = HGVS_result_create();
+
+    pthread_mutex_lock(&pipeline->lock);
+    for (;;)
+    {
+        // other workers may claim chunks while this one waits
+        Chunk* chunk = &pipeline->chunks[pipeline->claimed % pipeline->count];
+        while (chunk->state != CHUNK_FILLED && !(pipeline->eof && pipeline->claimed == pipeline->filled))
+        {
+            pthread_cond_wait(&pipeline->changed, &pipeline->lock);
+            chunk = &pipeline->chunks[pipeline->claimed % pipeline->count];
+        } // while
+        if (chunk->state != CHUNK_FILLED)
+        {
+            break;
+        } // if
+        chunk->state = CHUNK_PARSING;
+        pipeline->claimed += 1;
+        pthread_mutex_unlock(&pipeline->lock);
+
+        if (result != NULL)
+        {
+            parse_chunk(result, chunk, pipeline->options);
+        } // if
+        else
+        {
+            chunk->error = true;
+        } // else
+
+        pthread_mutex_lock(&pipeline->lock);
+        chunk->state = CHUNK_DONE;
+        pthread_cond_broadcast(&pipeline->changed);
+    } // for
+    if (pipeline->options->stats != NULL && result != NULL)
+    {
+        HGVS_result_add_stats(pipeline->options->stats, result);
+    } // if
+    pthread_mutex_unlock(&pipeline->lock);
+
+    HGVS_result_destroy(result);
+    return NULL;
+} // worker
+
+
+static void*
+writer(void* const arg)
+{
+    Pipeline* const pipeline = arg;
+
+    pthread_mutex_lock(&pipeline->lock);
+    for (size_t seq = 0; ; ++seq)
+    {
+        Chunk* const chunk = &pipeline->chunks[seq % pipeline->count];
+        while (chunk->state != CHUNK_DONE && !(pipeline->eof && seq == pipeline->filled))
+        {
+            pthread_cond_wait(&pipeline->changed, &pipeline->lock);
+        } // while
+        if (chunk->state != CHUNK_DONE)
+        {
+            break;
+        } // if
+        pthread_mutex_unlock(&pipeline->lock);
+
+        bool const ok = !pipeline->error && write_chunk(chunk);
+
+        pthread_mutex_lock(&pipeline->lock);
+        pipeline->lines += chunk->lines;
+        pipeline->failed += chunk->failed;
+        pipeline->error = pipeline->error || !ok;
+        chunk->state = CHUNK_FREE;
+        pthread_cond_broadcast(&pipeline->changed);
+    } // for
+    pthread_mutex_unlock(&pipeline->lock);
+    return NULL;
+} // writer
+
+
+static bool
+batch_sequential(Reader* const reader, Options const* const options, size_t* const failed)
+{
+    HGVS_Result* const result = HGVS_result_create();
+    Chunk chunk = {
+        .state  = CHUNK_FREE,
+        .input  = {NULL, 0, 0},
+        .lines  = 0,
+        .failed = 0,
+        .error  = false
+    }; // chunk
+    HGVS_output_init(&chunk.output, NULL, options->fmt);
+
+    bool ok = result != NULL;
+    while (ok && read_chunk(reader, &chunk))
+    {
+        parse_chunk(result, &chunk, options);
+        *failed += chunk.failed;
+        ok = write_chunk(&chunk);
+    } // while
+    if (options->stats != NULL && result != NULL)
+    {
+        HGVS_result_add_stats(options->stats, result);
+    } // if
+
+    buffer_destroy(&chunk.input);
+    HGVS_output_destroy(&chunk.output);
+    HGVS_result_destroy(result);
+    return ok && !reader->error;
+} // batch_sequential
+
+
+static bool
+batch_parallel(Reader* const        reader,
+               size_t const         threads,
+               Options const* const options,
+               size_t* const        failed)
+{
+    Pipeline pipeline = {
+        .chunks  = calloc(threads * 4, sizeof(Chunk)),
+        .count   = threads * 4,
+        .filled  = 0,
+        .claimed = 0,
+        .eof     = false,
+        .lines   = 0,
+        .failed  = 0,
+        .error   = false,
+        .options = options
+    }; // pipeline
+    pthread_t* const tids = calloc(threads + 1, sizeof(*tids));
+    if (pipeline.chunks == NULL || tids == NULL)
+    {
+        fprintf(stderr, "allocation error; out of memory?\n");
+        free(pipeline.chunks);
+        free(tids);
+        return false;
+    } // if
+    pthread_mutex_init(&pipeline.lock, NULL);
+    pthread_cond_init(&pipeline.changed, NULL);
+
+    size_t started = 0;
+    if (pthread_create(&tids[0], NULL, writer, &pipeline) == 0)
+    {
+        started = 1;
+        while (started <= threads && pthread_create(&tids[started], NULL, worker, &pipeline) == 0)
+        {
+            started += 1;
+        } // while
+    } // if
+
+    // the calling thread is the reader
+    pthread_mutex_lock(&pipeline.lock);
+    while (started > 1 && !pipeline.error)
+    {
+        Chunk* const chunk = &pipeline.chunks[pipeline.filled % pipeline.count];
+        while (chunk->state != CHUNK_FREE)
+        {
+            pthread_cond_wait(&pipeline.changed, &pipeline.lock);
+        } // while
+        pthread_mutex_unlock(&pipeline.lock);
+
+        bool const more = read_chunk(reader, chunk);
+
+        pthread_mutex_lock(&pipeline.lock);
+        if (!more)
+        {
+            break;
+        } // if
+        chunk->state = CHUNK_FILLED;
+        pipeline.filled += 1;
+        pthread_cond_broadcast(&pipeline.changed);
+    } // while
+    pipeline.eof = true;
+    pthread_cond_broadcast(&pipeline.changed);
+    pthread_mutex_unlock(&pipeline.lock);
+
+    for (size_t i = 0; i < started; ++i)
+    {
+        pthread_join(tids[i], NULL);
+    } // for
+
+    bool const ok = started > 1 && !pipeline.error && !reader->error;
+    if (started <= 1)
+    {
+        fprintf(stderr, "cannot start threads\n");
+    } // if
+    *failed += pipeline.failed;
+
+    for (size_t i = 0; i < pipeline.count; ++i)
+    {
+        buffer_destroy(&pipeline.chunks[i].input);
+        HGVS_output_destroy(&pipeline.chunks[i].output);
+    } // for
+    pthread_cond_destroy(&pipeline.changed);
+    pthread_mutex_destroy(&pipeline.lock);
+    free(pipeline.chunks);
+    free(tids);
+    return ok;
+} // batch_parallel
+
+
+static bool
+parse_size(char const* const str, size_t* const num)
+{
+    char* end = NULL;
+    unsigned long long const val = strtoull(str, &end, 10);
+    if (*str == '\0' || *str == '-' || *end != '\0' || val == 0)
+    {
+        return false;
+    } // if
+    *num = val;
+    return true;
+} // parse_size
+
+
+static int
+batch_main(int const argc, char* argv[], char const* const name)
+{
+    long const online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t threads = online > 0 ? (size_t) online : 1;
+
+    Reader reader = {
+        .files       = NULL,
+        .count       = 0,
+        .index       = 0,
+        .stream      = NULL,
+        .block       = {NULL, 0, 0},
+        .pos         = 0,
+        .chunk_lines = BATCH_CHUNK_LINES,
+        .error       = false
+    }; // reader
+
+    Options options = {
+        .fmt       = HGVS_Format_plain,
+        .canonical = false,
+        .cache     = NULL,
+        .store     = NULL,
+        .stats     = NULL
+    }; // options
+    bool stats = false;
+    size_t entries = 0;
+    char const* path = NULL;
+
+    int i = 0;
+    for (; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-n") == 0)
+        {
+            options.canonical = true;
+        } // if
+        else if (strcmp(argv[i], "-j") == 0)
+        {
+            options.fmt = HGVS_Format_json;
+        } // if
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc && parse_size(argv[i + 1], &entries))
+        {
+            i += 1;
+        } // if
+        else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc && path == NULL)
+        {
+            path = argv[i + 1];
+            i += 1;
+        } // if
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc && parse_size(argv[i + 1], &threads))
+        {
+            i += 1;
+        } // if
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc && parse_size(argv[i + 1], &reader.chunk_lines))
+        {
+            i += 1;
+        } // if
+        else if (strcmp(argv[i], "--stats") == 0)
+        {
+            stats = true;
+        } // if
+        else if (argv[i][0] == '-' && argv[i][1] != '\0')
+        {
+            usage(name);
+            return EXIT_FAILURE;
+        } // if
+        else
+        {
+            break;
+        } // else
+    } // for
+
+    static char* stdin_only[] = {"-"};
+    reader.files = i < argc ? argv + i : stdin_only;
+    reader.count = i < argc ? argc - i : 1;
+
+    if (entries > 0 && path != NULL)
+    {
+        usage(name);
+        return EXIT_FAILURE;
+    } // if
+    if (path != NULL)
+    {
+        options.store = HGVS_store_open(path, options.fmt == HGVS_Format_json || options.canonical);
+        if (options.store == NULL)
+        {
+            fprintf(stderr, "%s: cannot open as a store of this version\n", path);
+            return EXIT_FAILURE;
+        } // if
+    } // if
+    if (entries > 0)
+    {
+        options.cache = HGVS_cache_create(entries, options.fmt == HGVS_Format_json || options.canonical);
+        if (options.cache == NULL)
+        {
+            fprintf(stderr, "allocation error; out of memory?\n");
+            return EXIT_FAILURE;
+        } // if
+    } // if
+
+    if (stats)
+    {
+        options.stats = HGVS_result_create();
+        if (options.stats == NULL)
+        {
+            fprintf(stderr, "allocation error; out of memory?\n");
+            return EXIT_FAILURE;
+        } // if
+    } // if
+
+    setvbuf(stdout, NULL, _IOFBF, BATCH_BLOCK_SIZE);
+
+    size_t failed = 0;
+    bool const ok = threads <= 1 ? batch_sequential(&reader, &options, &failed)
+                                 : batch_parallel(&reader, threads, &options, &failed);
+
+    if (options.cache != NULL)
+    {
+        fflush(stdout);
+        fprintf(stderr, "cache\t%zu hits\t%zu misses\n",
+                HGVS_cache_hits(options.cache), HGVS_cache_misses(options.cache));
+        HGVS_cache_destroy(options.cache);
+    } // if
+    if (options.store != NULL)
+    {
+        fflush(stdout);
+        fprintf(stderr, "store\t%zu hits\t%zu misses\n",
+                HGVS_store_hits(options.store), HGVS_store_misses(options.store));
+        HGVS_store_close(options.store);
+    } // if
+    if (options.stats != NULL)
+    {
+        fflush(stdout);
+        if (HGVS_result_print_stats(stderr, options.stats) == 0)
+        {
+            fprintf(stderr, "no counters; build with make OPTIONS='STATS'\n");
+        } // if
+        HGVS_result_destroy(options.stats);
+    } // if
+
+    if (reader.stream != NULL && reader.stream != stdin)
+    {
+        fclose(reader.stream);
+    } // if
+    buffer_destroy(&reader.block);
+
+    if (!ok || failed > 0)
+    {
+        return EXIT_FAILURE;
+    } // if
+    return EXIT_SUCCESS;
+} // batch_main
+
+
 int
 main(int argc, char* argv[])
 {
+    if (argc > 1 && strcmp(argv[1], "-b") == 0)
+    {
+        return batch_main(argc - 2, argv + 2, argv[0]);
+    } // if
+
     fprintf(stderr, "HGVS parser " HGVS_VERSION_STRING "\n");
     if (argc <= 1)
     {
-        fprintf(stderr, "Usage: %s string\n", argv[0]);
+        usage(argv[0]);
         return EXIT_FAILURE;
     } // if
 
@@ -0,0 +1,205 @@
+#include <stddef.h>
+
+
+#include "../include/lexer.h"
+#include "../include/scan.h"
+
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCAN_X86
+#include <immintrin.h>
+#endif
+
+
+static char const*
+scan_IUPAC_NT_scalar(char const* ptr, char const* const end)
+{
+    while (ptr < end && is_IUPAC_NT(*ptr))
+    {
+        ptr += 1;
+    } // while
+    return ptr;
+} // scan_IUPAC_NT_scalar
+
+
+static char const*
+scan_identifier_scalar(char const* ptr, char const* const end)
+{
+    while (ptr < end && is_identifier(*ptr))
+    {
+        ptr += 1;
+    } // while
+    return ptr;
+} // scan_identifier_scalar
+
+
+#if defined(SCAN_X86)
+
+
+// letters after folding to lower case: c | 0x20 is in 'a'..'z' only
+// for ASCII letters; bytes >= 0x80 are negative and never match
+__attribute__((target("sse2")))
+static inline __m128i
+sse2_letter(__m128i const lower)
+{
+    return _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                         _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+} // sse2_letter
+
+
+__attribute__((target("sse2")))
+static char const*
+scan_IUPAC_NT_sse2(char const* ptr, char const* const end)
+{
+    while (end - ptr >= 16)
+    {
+        __m128i const vec = _mm_loadu_si128((__m128i const*) ptr);
+        __m128i const lower = _mm_or_si128(vec, _mm_set1_epi8(0x20));
+
+        // the ten letters that are not IUPAC nucleotides
+        __m128i other = _mm_cmpeq_epi8(lower, _mm_set1_epi8('e'));
+        other = _mm_or_si128(other, _mm_cmpeq_epi8(lower, _mm_set1_epi8('f')));
+        other = _mm_or_si128(other, _mm_cmpeq_epi8(lower, _mm_set1_epi8('i')));
+        other = _mm_or_si128(other, _mm_cmpeq_epi8(lower, _mm_set1_epi8('j')));
+        other = _mm_or_si128(other, _mm_cmpeq_epi8(lower, _mm_set1_epi8('l')));
+        other = _mm_or_si128(other, _mm_cmpeq_epi8(lower, _mm_set1_epi8('o')));
+        other = _mm_or_si128(other, _mm_cmpeq_epi8(lower, _mm_set1_epi8('p')));
+        other = _mm_or_si128(other, _mm_cmpeq_epi8(lower, _mm_set1_epi8('q')));
+        other = _mm_or_si128(other, _mm_cmpeq_epi8(lower, _mm_set1_epi8('x')));
+        other = _mm_or_si128(other, _mm_cmpeq_epi8(lower, _mm_set1_epi8('z')));
+
+        unsigned const mask = _mm_movemask_epi8(_mm_andnot_si128(other, sse2_letter(lower)));
+        if (mask != 0xFFFF)
+        {
+            return ptr + __builtin_ctz(~mask);
+        } // if
+        ptr += 16;
+    } // while
+    return scan_IUPAC_NT_scalar(ptr, end);
+} // scan_IUPAC_NT_sse2
+
+
+__attribute__((target("sse2")))
+static char const*
+scan_identifier_sse2(char const* ptr, char const* const end)
+{
+    while (end - ptr >= 16)
+    {
+        __m128i const vec = _mm_loadu_si128((__m128i const*) ptr);
+        __m128i const lower = _mm_or_si128(vec, _mm_set1_epi8(0x20));
+
+        __m128i match = sse2_letter(lower);
+        match = _mm_or_si128(match, _mm_and_si128(_mm_cmpgt_epi8(vec, _mm_set1_epi8('0' - 1)),
+                                                  _mm_cmplt_epi8(vec, _mm_set1_epi8('9' + 1))));
+        match = _mm_or_si128(match, _mm_cmpeq_epi8(vec, _mm_set1_epi8('.')));
+        match = _mm_or_si128(match, _mm_cmpeq_epi8(vec, _mm_set1_epi8('_')));
+
+        unsigned const mask = _mm_movemask_epi8(match);
+        if (mask != 0xFFFF)
+        {
+            return ptr + __builtin_ctz(~mask);
+        } // if
+        ptr += 16;
+    } // while
+    return scan_identifier_scalar(ptr, end);
+} // scan_identifier_sse2
+
+
+// Set membership for ASCII with two nibble lookups: the high nibble
+// selects a bit (zero for bytes >= 0x80), the low nibble the set of
+// high nibbles that form a member together with it.
+__attribute__((target("avx2")))
+static inline unsigned
+avx2_members(__m256i const vec, __m256i const lut_low)
+{
+    __m256i const lut_high = _mm256_setr_epi8(
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char) 0x80, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char) 0x80, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m256i const nibble = _mm256_set1_epi8(0x0F);
+
+    __m256i const low = _mm256_shuffle_epi8(lut_low, _mm256_and_si256(vec, nibble));
+    __m256i const high = _mm256_shuffle_epi8(lut_high, _mm256_and_si256(_mm256_srli_epi16(vec, 4), nibble));
+    __m256i const none = _mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256());
+    return ~(unsigned) _mm256_movemask_epi8(none);
+} // avx2_members
+
+
+__attribute__((target("avx2")))
+static char const*
+scan_IUPAC_NT_avx2(char const* ptr, char const* const end)
+{
+    __m256i const lut_low = _mm256_setr_epi8(
+        0x00, 0x50, (char) 0xF0, (char) 0xF0, (char) 0xF0, (char) 0xA0, (char) 0xA0, (char) 0xF0,
+        0x50, (char) 0xA0, 0x00, 0x50, 0x00, 0x50, 0x50, 0x00,
+        0x00, 0x50, (char) 0xF0, (char) 0xF0, (char) 0xF0, (char) 0xA0, (char) 0xA0, (char) 0xF0,
+        0x50, (char) 0xA0, 0x00, 0x50, 0x00, 0x50, 0x50, 0x00);
+    while (end - ptr >= 32)
+    {
+        unsigned const mask = avx2_members(_mm256_loadu_si256((__m256i const*) ptr), lut_low);
+        if (mask != 0xFFFFFFFF)
+        {
+            return ptr + __builtin_ctz(~mask);
+        } // if
+        ptr += 32;
+    } // while
+    return scan_IUPAC_NT_sse2(ptr, end);
+} // scan_IUPAC_NT_avx2
+
+
+__attribute__((target("avx2")))
+static char const*
+scan_identifier_avx2(char const* ptr, char const* const end)
+{
+    __m256i const lut_low = _mm256_setr_epi8(
+        (char) 0xA8, (char) 0xF8, (char) 0xF8, (char) 0xF8, (char) 0xF8, (char) 0xF8, (char) 0xF8, (char) 0xF8,
+        (char) 0xF8, (char) 0xF8, (char) 0xF0, 0x50, 0x50, 0x50, 0x54, 0x70,
+        (char) 0xA8, (char) 0xF8, (char) 0xF8, (char) 0xF8, (char) 0xF8, (char) 0xF8, (char) 0xF8, (char) 0xF8,
+        (char) 0xF8, (char) 0xF8, (char) 0xF0, 0x50, 0x50, 0x50, 0x54, 0x70);
+    while (end - ptr >= 32)
+    {
+        unsigned const mask = avx2_members(_mm256_loadu_si256((__m256i const*) ptr), lut_low);
+        if (mask != 0xFFFFFFFF)
+        {
+            return ptr + __builtin_ctz(~mask);
+        } // if
+        ptr += 32;
+    } // while
+    return scan_identifier_sse2(ptr, end);
+} // scan_identifier_avx2
+
+
+#endif
+
+
+char const*
+scan_IUPAC_NT(char const* ptr, char const* const end)
+{
+#if defined(SCAN_X86)
+    if (end - ptr >= 32 && __builtin_cpu_supports("avx2"))
+    {
+        return scan_IUPAC_NT_avx2(ptr, end);
+    } // if
+    if (end - ptr >= 16 && __builtin_cpu_supports("sse2"))
+    {
+        return scan_IUPAC_NT_sse2(ptr, end);
+    } // if
+#endif
+    return scan_IUPAC_NT_scalar(ptr, end);
+} // scan_IUPAC_NT
+
+
+char const*
+scan_identifier(char const* ptr, char const* const end)
+{
+#if defined(SCAN_X86)
+    if (end - ptr >= 32 && __builtin_cpu_supports("avx2"))
+    {
+        return scan_identifier_avx2(ptr, end);
+    } // if
+    if (end - ptr >= 16 && __builtin_cpu_supports("sse2"))
+    {
+        return scan_identifier_sse2(ptr, end);
+    } // if
+#endif
+    return scan_identifier_scalar(ptr, end);
+} // scan_identifier
@@ -0,0 +1,334 @@
+#define _POSIX_C_SOURCE 200809L
+
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+#include "../include/hgvs.h"
+
+
+// Parses every line of the given corpora in this process and compares
+// each verdict and canonical form (or error) with the expected output
+// next to the corpus: the .out file of the same name, as written by
+//     ./a.out -b -n corpus.in > corpus.out
+// Every canonical form must parse to itself again, and recognizing an
+// input must give the same verdict and error as parsing it. Reports per
+// corpus the lines, the rejected ones, the mismatches and the time. With
+// -w the expected outputs are written instead. Built by `make check`;
+// `make check-asan` runs it under AddressSanitizer. Usage:
+//     tests/check [-w] corpus.in ...
+typedef struct Corpus
+{
+    char const* name;
+    size_t      lines;
+    size_t      failed;
+    size_t      mismatched;
+    double      ns;
+} Corpus;
+
+
+static double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+} // now
+
+
+// the whole file, NUL-terminated; NULL on failure
+static char*
+slurp(char const* const path, size_t* const len)
+{
+    FILE* const stream = fopen(path, "rb");
+    if (stream == NULL)
+    {
+        return NULL;
+    } // if
+    char* data = NULL;
+    size_t size = 0;
+    *len = 0;
+    for (;;)
+    {
+        if (*len + 1 >= size)
+        {
+            size = size > 0 ? 2 * size : 4096;
+            char* const tmp = realloc(data, size);
+            if (tmp == NULL)
+            {
+                free(data);
+                fclose(stream);
+                return NULL;
+            } // if
+            data = tmp;
+        } // if
+        size_t const count = fread(data + *len, 1, size - *len - 1, stream);
+        *len += count;
+        if (count == 0)
+        {
+            break;
+        } // if
+    } // for
+    bool const error = ferror(stream);
+    fclose(stream);
+    if (error)
+    {
+        free(data);
+        return NULL;
+    } // if
+    data[*len] = '\0';
+    return data;
+} // slurp
+
+
+// corpus.in -> corpus.out; NULL if out of memory
+static char*
+expected_path(char const* const path)
+{
+    size_t len = strlen(path);
+    if (len > 3 && strcmp(path + len - 3, ".in") == 0)
+    {
+        len -= 3;
+    } // if
+    char* const res = malloc(len + 5);
+    if (res != NULL)
+    {
+        memcpy(res, path, len);
+        memcpy(res + len, ".out", 5);
+    } // if
+    return res;
+} // expected_path
+
+
+// As batch mode (see src/main.c): the first field of the line, then the
+// verdict, and the canonical form or the offset and message of the error.
+static void
+write_line(HGVS_Output* const       output,
+           HGVS_Result const* const result,
+           char const* const        str,
+           size_t const             len)
+{
+    if (HGVS_result_accepted(result))
+    {
+        HGVS_output_puts(output, "accepted\t");
+        HGVS_output_write(output, str, len);
+        HGVS_output_putc(output, '\t');
+        size_t const size = HGVS_result_canonical(result, NULL, 0);
+        char* const dst = HGVS_output_reserve(output, size + 1);
+        if (dst != NULL)
+        {
+            output->len += HGVS_result_canonical(result, dst, size + 1);
+        } // if
+    } // if
+    else
+    {
+        HGVS_output_puts(output, "failed\t");
+        HGVS_output_write(output, str, len);
+        HGVS_output_putc(output, '\t');
+        HGVS_output_decimal(output, HGVS_result_error_offset(result));
+        HGVS_output_putc(output, '\t');
+        HGVS_output_puts(output, HGVS_result_error_message(result));
+    } // else
+    HGVS_output_putc(output, '\n');
+} // write_line
+
+
+// what, if anything, is wrong beyond the expected output
+static char const*
+verify(HGVS_Result* const result, HGVS_Result* const other, char const* const str, size_t const len)
+{
+    bool const accepted = HGVS_result_accepted(result);
+    HGVS_result_recognize_n(other, str, len);
+    if (HGVS_result_accepted(other) != accepted ||
+        HGVS_result_error_offset(other) != HGVS_result_error_offset(result) ||
+        HGVS_result_error(other) != HGVS_result_error(result))
+    {
+        return "recognized differently";
+    } // if
+    if (!accepted)
+    {
+        return NULL;
+    } // if
+
+    size_t const size = HGVS_result_canonical(result, NULL, 0);
+    char* const canonical = malloc(2 * (size + 1));
+    if (canonical == NULL)
+    {
+        return "out of memory";
+    } // if
+    HGVS_result_canonical(result, canonical, size + 1);
+    char const* res = NULL;
+    if (HGVS_result_parse_n(other, canonical, size) != 0)
+    {
+        res = "canonical form rejected";
+    } // if
+    else if (HGVS_result_canonical(other, canonical + size + 1, size + 1) != size ||
+             memcmp(canonical, canonical + size + 1, size) != 0)
+    {
+        res = "canonical form not stable";
+    } // if
+    free(canonical);
+    return res;
+} // verify
+
+
+static int
+check(HGVS_Result* const result, HGVS_Result* const other, Corpus* const corpus, bool const write)
+{
+    char* const path = expected_path(corpus->name);
+    size_t len = 0;
+    char* const input = slurp(corpus->name, &len);
+    size_t expected_len = 0;
+    char* const expected = write || path == NULL ? NULL : slurp(path, &expected_len);
+    if (path == NULL || input == NULL || (!write && expected == NULL))
+    {
+        perror(input == NULL ? corpus->name : path != NULL ? path : "tests/check");
+        free(path);
+        free(input);
+        free(expected);
+        return -1;
+    } // if
+
+    HGVS_Output output;
+    HGVS_output_init(&output, NULL, HGVS_Format_plain);
+    HGVS_Output all;
+    HGVS_output_init(&all, NULL, HGVS_Format_plain);
+
+    char const* line = input;
+    char const* const end = input + len;
+    char const* want = expected;
+    char const* const want_end = expected != NULL ? expected + expected_len : NULL;
+    while (line < end)
+    {
+        char const* eol = memchr(line, '\n', end - line);
+        if (eol == NULL)
+        {
+            eol = end;
+        } // if
+        char const* str = line;
+        while (str < eol && (*str == ' ' || *str == '\t'))
+        {
+            str += 1;
+        } // while
+        char const* tok = str;
+        while (tok < eol && *tok != ' ' && *tok != '\t' && *tok != '\r')
+        {
+            tok += 1;
+        } // while
+        line = eol + 1;
+        corpus->lines += 1;
+
+        double const start = now();
+        HGVS_result_parse_n(result, str, tok - str);
+        corpus->ns += now() - start;
+        if (!HGVS_result_accepted(result))
+        {
+            corpus->failed += 1;
+        } // if
+
+        output.len = 0;
+        write_line(&output, result, str, tok - str);
+        if (output.error)
+        {
+            fprintf(stderr, "tests/check: out of memory\n");
+            break;
+        } // if
+        if (write)
+        {
+            HGVS_output_write(&all, output.data, output.len);
+            continue;
+        } // if
+
+        char const* const problem = verify(result, other, str, tok - str);
+        size_t const have = want < want_end ? (size_t) (want_end - want) : 0;
+        char const* const want_eol = have > 0 ? memchr(want, '\n', have) : NULL;
+        size_t const want_len = want_eol != NULL ? (size_t) (want_eol - want) : have;
+        size_t const got_len = output.len - 1;  // without the newline
+        if (problem != NULL || want_len != got_len || memcmp(want, output.data, got_len) != 0)
+        {
+            corpus->mismatched += 1;
+            fprintf(stderr, "%s:%zu: %s\n    expected: %.*s\n    got:      %.*s\n",
+                    corpus->name, corpus->lines, problem != NULL ? problem : "unexpected output",
+                    (int) want_len, want, (int) got_len, output.data);
+        } // if
+        want += want_eol != NULL ? want_len + 1 : want_len;
+    } // while
+    if (!write && want < want_end)
+    {
+        corpus->mismatched += 1;
+        fprintf(stderr, "%s: more lines expected\n", corpus->name);
+    } // if
+
+    int ret = output.error || all.error ? -1 : 0;
+    if (write && ret == 0)
+    {
+        FILE* const stream = fopen(path, "wb");
+        if (stream == NULL || fwrite(all.data, 1, all.len, stream) != all.len)
+        {
+            perror(path);
+            ret = -1;
+        } // if
+        if (stream != NULL && fclose(stream) != 0)
+        {
+            perror(path);
+            ret = -1;
+        } // if
+    } // if
+
+    HGVS_output_destroy(&output);
+    HGVS_output_destroy(&all);
+    free(path);
+    free(input);
+    free(expected);
+    return ret;
+} // check
+
+
+int
+main(int argc, char* argv[])
+{
+    bool const write = argc > 1 && strcmp(argv[1], "-w") == 0;
+    int const first = write ? 2 : 1;
+    if (argc <= first)
+    {
+        fprintf(stderr, "usage: %s [-w] corpus.in ...\n", argv[0]);
+        return EXIT_FAILURE;
+    } // if
+
+    HGVS_Result* const result = HGVS_result_create();
+    HGVS_Result* const other = HGVS_result_create();
+    if (result == NULL || other == NULL)
+    {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        HGVS_result_destroy(result);
+        HGVS_result_destroy(other);
+        return EXIT_FAILURE;
+    } // if
+
+    int ret = EXIT_SUCCESS;
+    printf("corpus\tlines\tfailed\tmismatched\tms\tns per line\n");
+    for (int i = first; i < argc; ++i)
+    {
+        Corpus corpus = {
+            .name       = argv[i],
+            .lines      = 0,
+            .failed     = 0,
+            .mismatched = 0,
+            .ns         = 0
+        }; // corpus
+        if (check(result, other, &corpus, write) != 0 || corpus.mismatched > 0)
+        {
+            ret = EXIT_FAILURE;
+        } // if
+        printf("%s\t%zu\t%zu\t%zu\t%.3f\t%.1f\n", corpus.name, corpus.lines, corpus.failed, corpus.mismatched,
+               corpus.ns / 1e6, corpus.lines > 0 ? corpus.ns / corpus.lines : 0.0);
+    } // for
+
+    HGVS_result_destroy(result);
+    HGVS_result_destroy(other);
+    return ret;
+} // main
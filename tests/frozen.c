@@ -0,0 +1,299 @@
+#define _POSIX_C_SOURCE 200809L
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+#include "../include/hash.h"
+#include "../include/hgvs.h"
+
+
+// Thaws frozen trees whose nodes refer to themselves or to an ancestor,
+// directly and through a store file whose record is crafted with a
+// valid checksum: each must be rejected (and the store must parse the
+// input again) instead of being handed to print() and json(), which
+// would walk them forever. Neither may a thawed tree bring its own
+// error messages, which are addresses, nor a store hand out a tree that
+// contradicts its record's verdict. Built and run by `make check`.
+// Usage:
+//     tests/frozen
+static char const INPUT[] = "NG_012232.1:g.[19_21del;22A>C]";
+static char const REJECTED[] = "REF:1A[";
+
+// the layout of a frozen tree: the root and the count, then the nodes
+// from the error record (index 3, with its context at 4) on, each 20
+// bytes: the left and right index, the offset, the data and the type;
+// see HGVS_result_freeze()
+static size_t const FROZEN_HEADER   = 8;
+static size_t const NODE_SIZE       = 20;
+static uint32_t const ERROR_INDEX   = 3;
+static uint32_t const CONTEXT_INDEX = 4;
+static size_t const RIGHT = 4;
+static size_t const DATA  = 12;
+static size_t const TYPE  = 16;
+
+// the layout of a store file: the header, then records of 40 bytes,
+// each with its check first; see src/hgvs_store.c
+static size_t const STORE_HEADER = 32;
+static size_t const RECORD_SIZE  = 40;
+
+
+static size_t failures = 0;
+
+
+static void
+expect(bool const condition, char const* const what)
+{
+    if (!condition)
+    {
+        failures += 1;
+        fprintf(stderr, "tests/frozen: %s\n", what);
+    } // if
+} // expect
+
+
+static uint32_t
+get(char const* const tree, size_t const at)
+{
+    uint32_t value;
+    memcpy(&value, tree + at, sizeof(value));
+    return value;
+} // get
+
+
+static void
+put(char* const tree, size_t const at, uint32_t const value)
+{
+    memcpy(tree + at, &value, sizeof(value));
+} // put
+
+
+// where the left index (or the first of an item node) of a node is
+static size_t
+left_of(uint32_t const index)
+{
+    return FROZEN_HEADER + (index - ERROR_INDEX) * NODE_SIZE;
+} // left_of
+
+
+// the root refers to itself
+static void
+self(char* const tree)
+{
+    uint32_t const root = get(tree, 0);
+    put(tree, left_of(root), root);
+} // self
+
+
+// the root's reference refers to the root
+static void
+ancestor(char* const tree)
+{
+    uint32_t const root = get(tree, 0);
+    put(tree, left_of(get(tree, left_of(root))), root);
+} // ancestor
+
+
+// the first variant of the allele is the root
+static void
+item(char* const tree)
+{
+    uint32_t const root = get(tree, 0);
+    uint32_t const allele = get(tree, left_of(root) + sizeof(uint32_t));
+    put(tree, left_of(get(tree, left_of(allele))), root);
+} // item
+
+
+// the root is an error context, with a message of its own
+static void
+context(char* const tree)
+{
+    tree[left_of(get(tree, 0)) + TYPE] = HGVS_Node_error_context;
+} // context
+
+
+static void
+thaw(HGVS_Result* const result, char const* const frozen, size_t const size)
+{
+    static struct
+    {
+        char const* name;
+        void        (*corrupt)(char* const tree);
+    } const CASES[] =
+    {
+        {"a node referring to itself",    self},
+        {"a node referring to its parent", ancestor},
+        {"an item referring to the root", item},
+        {"a second error context",        context},
+    }; // CASES
+
+    char* const tree = malloc(size);
+    if (tree == NULL)
+    {
+        expect(false, "out of memory");
+        return;
+    } // if
+    memcpy(tree, frozen, size);
+    expect(HGVS_result_thaw(result, INPUT, strlen(INPUT), tree, size) == 0, "an intact tree is not thawed");
+    for (size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); ++i)
+    {
+        memcpy(tree, frozen, size);
+        CASES[i].corrupt(tree);
+        expect(HGVS_result_thaw(result, INPUT, strlen(INPUT), tree, size) == -1, CASES[i].name);
+        expect(HGVS_result_root(result) == NULL, "a rejected tree leaves a root");
+    } // for
+    free(tree);
+} // thaw
+
+
+// A rejected input's tree whose error message is an address of the
+// buffer's choosing, or whose error is not one: the message must be the
+// one of the error's code.
+static void
+messages(HGVS_Result* const result)
+{
+    if (HGVS_result_parse(result, REJECTED) != 1)
+    {
+        expect(false, "cannot reject the input");
+        return;
+    } // if
+    enum HGVS_Error const error = HGVS_result_error(result);
+    size_t const size = HGVS_result_freeze(result, NULL, 0);
+    char* const tree = malloc(size);
+    if (tree == NULL)
+    {
+        expect(false, "out of memory");
+        return;
+    } // if
+    HGVS_result_freeze(result, tree, size);
+    put(tree, left_of(CONTEXT_INDEX) + RIGHT, 0xDEAD);
+    put(tree, left_of(CONTEXT_INDEX) + DATA, 0xBEEF);
+    expect(HGVS_result_thaw(result, REJECTED, strlen(REJECTED), tree, size) == 1 &&
+           HGVS_result_error(result) == error &&
+           strcmp(HGVS_result_error_message(result), HGVS_error_message(error)) == 0,
+           "a thawed error keeps the message of the buffer");
+    put(tree, left_of(ERROR_INDEX) + DATA, 0xBEEF);
+    expect(HGVS_result_thaw(result, REJECTED, strlen(REJECTED), tree, size) == -1,
+           "an error without a code");
+    free(tree);
+} // messages
+
+
+// the root is the error record: the tree is of a rejected input
+static void
+rejected(char* const tree)
+{
+    put(tree, 0, ERROR_INDEX);
+} // rejected
+
+
+// The input's record gets a corrupt tree, with a valid check: the store
+// must parse the input again.
+static bool
+tamper(char const* const path, void (*corrupt)(char* const tree))
+{
+    FILE* const stream = fopen(path, "r+b");
+    if (stream == NULL)
+    {
+        return false;
+    } // if
+    char buf[4096];
+    size_t const len = fread(buf, 1, sizeof(buf), stream);
+    if (len < STORE_HEADER + RECORD_SIZE)
+    {
+        fclose(stream);
+        return false;
+    } // if
+    char* const record = buf + STORE_HEADER;
+    uint32_t const input_len = get(record, 16);
+    uint32_t const message_len = get(record, 20);
+    uint32_t const size = get(record, 24);
+    size_t const unpadded = RECORD_SIZE + input_len + message_len + 1 + size;
+    if (size == 0 || STORE_HEADER + unpadded > len)
+    {
+        fclose(stream);
+        return false;
+    } // if
+    corrupt(record + RECORD_SIZE + input_len + message_len + 1);
+    uint64_t const check = hash(record + sizeof(check), unpadded - sizeof(check));
+    memcpy(record, &check, sizeof(check));
+    bool const ok = fseek(stream, 0, SEEK_SET) == 0 && fwrite(buf, 1, len, stream) == len;
+    return fclose(stream) == 0 && ok;
+} // tamper
+
+
+// parses the input through a store at path, which is a hit or a miss
+static void
+through_store(HGVS_Result* const result, char const* const path, bool const hit)
+{
+    HGVS_Store* const store = HGVS_store_open(path, true);
+    if (store == NULL)
+    {
+        expect(false, "cannot open the store");
+        return;
+    } // if
+    HGVS_Verdict verdict;
+    expect(HGVS_store_parse_n(store, result, INPUT, strlen(INPUT), &verdict) == 0 && verdict.tree,
+           "the store does not accept the input with its tree");
+    expect(HGVS_store_hits(store) == (hit ? 1 : 0) && HGVS_store_misses(store) == (hit ? 0 : 1),
+           hit ? "the store misses an intact record" : "the store hits a crafted record");
+    char canonical[sizeof(INPUT)];
+    expect(HGVS_result_canonical(result, canonical, sizeof(canonical)) == strlen(INPUT) &&
+           strcmp(canonical, INPUT) == 0, "the store gives a different tree");
+    HGVS_store_close(store);
+} // through_store
+
+
+int
+main(void)
+{
+    HGVS_Result* const result = HGVS_result_create();
+    if (result == NULL || HGVS_result_parse(result, INPUT) != 0)
+    {
+        fprintf(stderr, "tests/frozen: cannot parse %s\n", INPUT);
+        HGVS_result_destroy(result);
+        return EXIT_FAILURE;
+    } // if
+
+    size_t const size = HGVS_result_freeze(result, NULL, 0);
+    char* const frozen = malloc(size);
+    if (frozen == NULL)
+    {
+        HGVS_result_destroy(result);
+        return EXIT_FAILURE;
+    } // if
+    HGVS_result_freeze(result, frozen, size);
+    thaw(result, frozen, size);
+    free(frozen);
+    messages(result);
+
+    char path[] = "/tmp/hgvs_frozen_XXXXXX";
+    int const fd = mkstemp(path);
+    if (fd == -1)
+    {
+        perror(path);
+        HGVS_result_destroy(result);
+        return EXIT_FAILURE;
+    } // if
+    close(fd);
+    through_store(result, path, false);
+    through_store(result, path, true);
+    expect(tamper(path, self), "cannot craft the record");
+    through_store(result, path, false);
+
+    // an accepted record with the tree of a rejected input
+    expect(truncate(path, 0) == 0, "cannot empty the store");
+    through_store(result, path, false);
+    expect(tamper(path, rejected), "cannot craft the record");
+    through_store(result, path, false);
+    unlink(path);
+
+    HGVS_result_destroy(result);
+    printf("frozen trees\t%zu failed\n", failures);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+} // main
@@ -0,0 +1,146 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#include "../include/lexer.h"
+
+
+// Compares match_number(), which takes digits 8 at a time where it can,
+// with one digit at a time and a check for overflow before every step:
+// on the boundary cases (the largest size_t, one more, leading zeros,
+// runs of digits ending on either side of every 8-byte word) and on
+// random runs of up to 24 digits, followed by random non-digits; a
+// million by default, `tests/number 20000000` for a longer run. Built
+// and run by `make check`. Usage:
+//     tests/number [runs [seed]]
+static size_t const RUNS       = 1000000;
+static size_t const MAX_DIGITS = 24;
+
+
+static char const* const BOUNDARIES[] =
+{
+    "0",
+    "9",
+    "1234567",
+    "12345678",
+    "123456789",
+    "123456789012345",
+    "1234567890123456",
+    "12345678901234567",
+    "250000000",
+    "33274278",
+    "1234567890123456789",
+    "9999999999999999999",
+    "10000000000000000000",
+    "18446744073709551615",
+    "18446744073709551616",
+    "18446744073709551620",
+    "19999999999999999999",
+    "99999999999999999999",
+    "000000000000000000018446744073709551615",
+    "000000000000000000018446744073709551616",
+    "123456789012345678901234",
+}; // BOUNDARIES
+
+
+static enum Number_Match
+reference(char const** const ptr, char const* const end, size_t* const num)
+{
+    char const* tmp = *ptr;
+    bool overflow = false;
+    *num = 0;
+    while (tmp < end && *tmp >= '0' && *tmp <= '9')
+    {
+        size_t const digit = *tmp - '0';
+        if (*num > (SIZE_MAX - digit) / 10)
+        {
+            overflow = true;
+        } // if
+        *num = *num * 10 + digit;
+        tmp += 1;
+    } // while
+    if (tmp == *ptr)
+    {
+        return NUMBER_UNMATCHED;
+    } // if
+    *ptr = tmp;
+    return overflow ? NUMBER_OVERFLOW : NUMBER_MATCHED;
+} // reference
+
+
+// whether match_number() agrees with the reference on input[0, len)
+static bool
+agrees(char const* const input, size_t const len)
+{
+    char const* ptr = input;
+    char const* expected_ptr = input;
+    size_t num = 0;
+    size_t expected_num = 0;
+    enum Number_Match const match = match_number(&ptr, input + len, &num);
+    enum Number_Match const expected = reference(&expected_ptr, input + len, &expected_num);
+    if (match == expected && ptr == expected_ptr && (match != NUMBER_MATCHED || num == expected_num))
+    {
+        return true;
+    } // if
+    fprintf(stderr, "tests/number: %.*s: %d %zu (%td) instead of %d %zu (%td)\n", (int) len, input,
+            match, num, ptr - input, expected, expected_num, expected_ptr - input);
+    return false;
+} // agrees
+
+
+static uint64_t
+next(uint64_t* const state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+} // next
+
+
+int
+main(int argc, char* argv[])
+{
+    size_t const runs = argc > 1 ? strtoull(argv[1], NULL, 10) : RUNS;
+    uint64_t state = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+    state = state == 0 ? 1 : state;
+
+    size_t failures = 0;
+    char input[64];
+    for (size_t i = 0; i < sizeof(BOUNDARIES) / sizeof(BOUNDARIES[0]); ++i)
+    {
+        size_t const len = strlen(BOUNDARIES[i]);
+        memcpy(input, BOUNDARIES[i], len);
+        // ending at the end of the input and followed by a non-digit
+        input[len] = '_';
+        failures += !agrees(input, len);
+        failures += !agrees(input, len + 1);
+    } // for
+
+    static char const OTHERS[] = "_.+-:;()[]?*/\0AZaz";
+    for (size_t i = 0; i < runs; ++i)
+    {
+        uint64_t const random = next(&state);
+        size_t const digits = random % (MAX_DIGITS + 1);
+        size_t const trailing = (random >> 8) % 9;
+        // mostly leading zeros, or mostly nines, to reach the boundary
+        size_t const kind = (random >> 16) % 4;
+        for (size_t j = 0; j < digits; ++j)
+        {
+            uint64_t const digit = next(&state);
+            input[j] = kind == 0 && j < digits / 2 ? '0' :
+                       kind == 1 && digit % 4 != 0 ? '9' : '0' + digit % 10;
+        } // for
+        for (size_t j = 0; j < trailing; ++j)
+        {
+            input[digits + j] = OTHERS[next(&state) % (sizeof(OTHERS) - 1)];
+        } // for
+        failures += !agrees(input, digits + trailing);
+    } // for
+
+    printf("numbers\t%zu failed\n", failures);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+} // main
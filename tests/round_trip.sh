@@ -0,0 +1,12 @@
+#!/bin/bash
+
+# Every description on stdin must be accepted in batch mode, and its
+# canonical form must parse to the same canonical form again.
+
+OUTPUT=$(./a.out -b -n)
+if [ $? -ne 0 ]; then
+    echo "${OUTPUT}" | grep -v '^accepted'
+    exit 1
+fi
+
+echo "${OUTPUT}" | cut -f 3 | ./a.out -b -n | awk -F '\t' '$2 != $3 { print; bad = 1 } END { exit bad }'